@@ -0,0 +1,67 @@
+#include <chrono>
+#include <bcli/bcli.hpp>
+
+using namespace bc;
+
+// Parses per second: rebuild the cli for each command line vs reparse a frozen one.
+
+void build(Parser<0>& cli)
+{
+  cli.add_param("-f/--file", "fof")->meta("FILE");
+  cli.add_param("--run-dir", "runtime directory")->meta("DIR");
+  cli.add_param("-k/--kmer-size", "size of k-mers")
+    ->checker(check::is_number)->def("31")->meta("INT");
+  cli.add_param("--count-abundance-min", "min abundance")
+    ->checker(check::is_number)->def("2")->meta("INT");
+  cli.add_param("--abundance-max", "max abundance")
+    ->checker(check::is_number)->def("3000000")->meta("INT");
+  cli.add_param("-m/--mode", "output matrix format")
+    ->checker(check::f::in("bin|ascii|pa|bf|bf_trp"))->def("bin")->meta("STR");
+  cli.add_param("--nb-cores", "number of cores")
+    ->checker(check::is_number)->def("8")->meta("INT");
+  cli.add_param("--keep-tmp", "keep tmp files")->as_flag();
+  cli.add_param("--lz4", "compress tmp files")->as_flag();
+  cli.add_group("advanced", {});
+  cli.add_param("--minimizer-type", "minimizer type")
+    ->checker(check::f::range(0, 1))->def("0")->meta("INT");
+  cli.add_param("--minimizer-size", "size of minimizer")
+    ->checker(check::is_number)->def("10")->meta("INT");
+  cli.add_param("--hasher", "sabuhash | xor")
+    ->checker(check::f::in("sabuhash|xor"))->def("xor")->meta("STR");
+  cli.add_common();
+}
+
+template<typename Fn>
+void run(const std::string& name, size_t n, Fn&& fn)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i=0; i<n; i++)
+    fn();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << std::setw(10) << std::left << name << " "
+            << static_cast<size_t>(n / elapsed.count()) << " parses/s" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n = argc > 1 ? std::stoull(argv[1]) : 100000;
+
+  char* args[] = {"bench", "-f", "fof.txt", "--run-dir", "run", "-k", "25", "-m", "bf",
+                  "--lz4", "--hasher", "sabuhash", "pos1", "pos2"};
+  int nargs = sizeof(args) / sizeof(char*);
+
+  run("rebuild", n, [&]() {
+    Parser<0> cli("bench", "bench", "v0.0.1");
+    build(cli);
+    cli.parse(nargs, args);
+  });
+
+  Parser<0> cli("bench", "bench", "v0.0.1");
+  build(cli);
+  cli.freeze();
+  run("reparse", n, [&]() {
+    cli.reparse(nargs, args);
+  });
+
+  return 0;
+}
@@ -29,6 +29,15 @@ int main(int argc, char* argv[])
     check::f::range(10, 100), p, c
   )->def("9");
 
+  // throw: 04_bcli_deps_bans -p 15 --min 10 --max 5
+  param_t min = cli.add_param("--min", "min")->def("0");
+  cli.add_param("--max", "max")->def("100")->relation(param::Rel::Gt, min);
+
+  // throw: 04_bcli_deps_bans -p 15 --gz --lz4
+  param_t gz = cli.add_param("--gz", "gzip output")->as_flag();
+  param_t lz4 = cli.add_param("--lz4", "lz4 output")->as_flag();
+  cli.mutually_exclusive({gz, lz4});
+
   cli.add_common();
 
   BCLI_PARSE(cli, argc, argv)
@@ -42,14 +51,18 @@ int main(int argc, char* argv[])
 //   ex04 desc
 //
 // USAGE
-//   ex04 -p/--param <?> [-d/--dep <?>] [-b/--ban <?>] [-h/--help] [-v/--verbose] [-d/--debug] 
-//        [--version] 
+//   ex04 -p/--param <?> [-d/--dep <?>] [-b/--ban <?>] [--min <?>] [--max <?>] [--gz] [--lz4] [-h/--help] 
+//        [-v/--verbose] [-d/--debug] [--version] 
 //
 // OPTIONS
 //   [global] - global parameters
 //     -p --param - param help 
 //     -d --dep   - dep help {120}
 //     -b --ban   - ban help {9}
+//        --min   - min {0}
+//        --max   - max {100}
+//        --gz    - gzip output [⚑]
+//        --lz4   - lz4 output [⚑]
 //
 //   [common]
 //     -h --help    - Show this message and exit. [⚑]
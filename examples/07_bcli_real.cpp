@@ -26,7 +26,8 @@ int main(int argc, char* argv[])
     ->checker(bc::check::is_number)->def("255")->meta("INT");
   
   cli.add_param("--max-memory", "max memory per core (in mb)")
-    ->checker(bc::check::is_number)->def("8000")->meta("INT");
+    ->checker(bc::check::is_number)->def("8000")->meta("INT")
+    ->def_provider(bc::provider::memory_per_core);
 
   bc::param_t mode = cli.add_param("-m/--mode", "output matrix format: [bin|ascii|pa|bf|bf_trp]")
     ->checker(bc::check::f::in("bin|ascii|pa|bf|bf_trp"))->def("bin")->meta("STR");
@@ -35,7 +36,8 @@ int main(int argc, char* argv[])
     ->checker(bc::check::f::in("repart|superk|count|merge|split"))->def("")->meta("STR");
 
   cli.add_param("--nb-cores", "number of cores")
-    ->checker(bc::check::is_number)->def("8")->meta("INT");
+    ->checker(bc::check::is_number)->def("8")->meta("INT")
+    ->def_provider(bc::provider::nb_cores);
 
   cli.add_param("--keep-tmp", "keep tmp files")->as_flag();
   cli.add_param("--lz4", "compress tmp files")->as_flag();
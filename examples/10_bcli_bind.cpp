@@ -0,0 +1,71 @@
+#include <bcli/bcli.hpp>
+
+using namespace bc;
+
+struct Options
+{
+  std::string file;
+  int kmer_size {0};
+  std::vector<int> abundances;
+  std::string mode;
+  bool lz4 {false};
+};
+
+BCLI_FIELDS(Options,
+  bc::field(&Options::file, "-f/--file"),
+  bc::field(&Options::kmer_size, "-k/--kmer-size"),
+  bc::field(&Options::abundances, "-a/--abundances"),
+  bc::field(&Options::mode, "-m/--mode"),
+  bc::field(&Options::lz4, "--lz4"))
+
+int main(int argc, char* argv[])
+{
+  Parser<0> cli("ex10",
+                "ex10 desc, try: ./10_bcli_bind -f file.txt -a 2,4 --lz4",
+                "v0.0.1",
+                "J. Doe");
+
+  cli.add_param("-f/--file", "a file")->meta("FILE");
+  cli.add_param("-k/--kmer-size", "size of k-mers")
+    ->checker(check::f::range(8, 64))->def("31")->meta("INT");
+  cli.add_param("-a/--abundances", "abundances")->multi<int>()->def("1")->meta("INT");
+  cli.add_param("-m/--mode", "mode")->checker(check::f::in("bin|ascii"))->def("bin")->meta("STR");
+  cli.add_param("--lz4", "compress")->as_flag();
+
+  cli.add_common();
+
+  BCLI_PARSE(cli, argc, argv)
+
+  Options opt = cli.bind<Options>();
+
+  std::cerr << "file " << opt.file << std::endl;
+  std::cerr << "kmer_size " << opt.kmer_size << std::endl;
+  std::cerr << "abundances " << opt.abundances.size() << std::endl;
+  std::cerr << "mode " << opt.mode << std::endl;
+  std::cerr << "lz4 " << opt.lz4 << std::endl;
+
+  return 0;
+}
+
+// ex10 v0.0.1
+//
+// DESCRIPTION
+//   ex10 desc, try: ./10_bcli_bind -f file.txt -a 2,4 --lz4
+//
+// USAGE
+//   ex10 -f/--file <FILE> [-k/--kmer-size <INT>] [-a/--abundances <INT...>] [-m/--mode <STR>] [--lz4] 
+//        [-h/--help] [-v/--verbose] [-d/--debug] [--version] 
+//
+// OPTIONS
+//   [global] - global parameters
+//     -f --file       - a file 
+//     -k --kmer-size  - size of k-mers {31}
+//     -a --abundances - abundances {1}
+//     -m --mode       - mode {bin}
+//        --lz4        - compress [⚑]
+//
+//   [common]
+//     -h --help    - Show this message and exit. [⚑]
+//     -v --verbose - Verbose mode. [⚑]
+//     -d --debug   - Debug mode. [⚑]
+//        --version - Show version and exit. [⚑]
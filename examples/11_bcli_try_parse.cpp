@@ -0,0 +1,46 @@
+#include <bcli/bcli.hpp>
+
+using namespace bc;
+
+// Built with -fno-exceptions, see examples/CMakeLists.txt
+int main(int argc, char* argv[])
+{
+  Parser<0> cli("ex11",
+                "ex11 desc, try: ./11_bcli_try_parse -k 2 -m txt --unknown",
+                "v0.0.1",
+                "J. Doe");
+
+  handle_t k = cli.handle(cli.add_param("-k/--kmer-size", "size of k-mers")
+    ->checker(check::f::range(8, 64))->def("31")->meta("INT"));
+  handle_t m = cli.handle(cli.add_param("-m/--mode", "mode")
+    ->checker(check::f::in("bin|ascii"))->def("bin")->meta("STR"));
+  cli.add_param("-f/--file", "a file")->meta("FILE")->checker(check::is_file);
+  cli.add_common();
+  cli.freeze();
+
+  Result res = cli.try_parse(argc, argv);
+
+  if (res.action() == Action::ShowHelp)
+  {
+    cli.show_help();
+    return 0;
+  }
+
+  if (!res)
+  {
+    for (auto& e : res.errors())
+      std::cerr << "[" << e.get_name() << "] -> " << e.get_msg() << std::endl;
+    return res.exit_code();
+  }
+
+  std::cerr << "kmer_size " << res.get<int>(k) << std::endl;
+  std::cerr << "mode " << res.get<std::string>(m) << std::endl;
+
+  return 0;
+}
+
+// $ ./11_bcli_try_parse -k 2 -m txt --unknown
+// [CheckFailedError] -> -k/--kmer-size 2 ~ Not in range [8,64].
+// [CheckFailedError] -> -m/--mode txt ~ Not in [bin|ascii]
+// [InvalidParamError] -> Unknown param: --unknown.
+// [RequiredParamError] -> -f/--file is required.
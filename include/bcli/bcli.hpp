@@ -36,9 +36,44 @@
 #include <iomanip>
 #include <vector>
 #include <array>
+#include <tuple>
 #include <unordered_map>
+#include <deque>
+#include <map>
+#include <optional>
+#include <any>
+#include <typeindex>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <algorithm>
 
 #include <cassert>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define BCLI_POSIX 1
+#endif
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sys/syscall.h>
+#define BCLI_GETDENTS 1
+#endif
 
 /**
  * @mainpage
@@ -50,6 +85,7 @@
  *  - @link Exceptions @endlink
  *  - @link Utilities @endlink
  *  - @link Checkers @endlink
+ *  - @link Providers @endlink
  *  - @link Param @endlink
  *  - @link ParamGroup @endlink
  *  - @link Command @endlink
@@ -65,6 +101,8 @@
  *  - @link 07_bcli_real.cpp @endlink
  *  - @link 08_bcli_help.cpp @endlink
  *  - @link 09_bcli_help_multiple.cpp @endlink
+ *  - @link 10_bcli_bind.cpp @endlink
+ *  - @link 11_bcli_try_parse.cpp @endlink
  */
 
 /**
@@ -112,6 +150,16 @@
  * @brief An example of customized help in multiple commands mode.
  */
 
+/**
+ * @example 10_bcli_bind.cpp
+ * @brief An example of struct binding.
+ */
+
+/**
+ * @example 11_bcli_try_parse.cpp
+ * @brief An example of exception-free parsing, built with -fno-exceptions.
+ */
+
 #define BCLI_VERSION "0.0.1"
 
 #ifdef _BCLI_TEST_
@@ -140,6 +188,7 @@ void unused(Args&&...) {}
 
 template<int Mode>
 class Parser;
+class Result;
 
 /**
  * @ingroup Configuration
@@ -167,7 +216,8 @@ class Param;
  *                .version(true)
  *                .flag_symbol("[F]")
  *                .default_group("main")
- *                .default_meta("STR");
+ *                .default_meta("STR")
+ *                .abbreviations(true); // --count-ab -> --count-abundance-min
  * @endcode
  */
 class Config
@@ -195,6 +245,7 @@ public:
   Config& flag_symbol(const std::string& sf) {m_flag_symbol = sf; return *this;}
   Config& default_group(const std::string& dg) {m_default_grp = dg; return *this;}
   Config& default_meta(const std::string& meta) {m_default_meta = meta; return *this;}
+  Config& abbreviations(bool v) {m_abbreviations = v; return *this;}
 
   bool has_common() {return m_help || m_verbose || m_debug || m_version;}
 
@@ -203,6 +254,7 @@ public:
   bool m_verbose {true};
   bool m_debug {true};
   bool m_version {true};
+  bool m_abbreviations {false};
 
   std::string m_default_grp {"global"};
   std::string m_flag_symbol {"⚑"};
@@ -228,17 +280,22 @@ public:
  *   - bc::ex::UnknownGroupError
  *   - bc::ex::CmdModeError
  *   - bc::ex::AlreadyExistsError
+ *   - bc::ex::NotFrozenError
+ *   - bc::ex::PatternError
  * - UsageError: handled by the main try/catch
  *   - bc::ex::FileNotFoundError
  *   - bc::ex::DirNotFoundError
  *   - bc::ex::CheckFailedError
  *   - bc::ex::MissingValueError
  *   - bc::ex::UnknownCmdError
+ *   - bc::ex::AmbiguousParamError
  *   - bc::ex::RequiredParamError
  *   - bc::ex::IncompatibleError
  *   - bc::ex::BannedError
  *   - bc::ex::DependsError
+ *   - bc::ex::RelationError
  *   - bc::ex::PostionalsError
+ *   - bc::ex::DuplicateInputError
  */
 
 /**
@@ -287,6 +344,34 @@ public:
 
 };
 
+/**
+ * @ingroup Exceptions
+ * @brief print an error and exit, replaces throw when exceptions are disabled
+ *
+ * @param e
+ */
+[[noreturn]] inline void fatal(const BCliError& e)
+{
+  if (!e.get_name().empty())
+    std::cerr << "[" << e.get_name() << "]" << " -> " << e.get_msg() << std::endl;
+  std::exit(EXIT_FAILURE);
+}
+
+/**
+ * @def BCLI_THROW
+ * @ingroup Exceptions
+ * @brief throw a bcli error, or print it and exit when built with -fno-exceptions
+ *
+ * Parser::try_parse never goes through BCLI_THROW for usage errors.
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+  #define BCLI_EXCEPTIONS 1
+  #define BCLI_THROW(e) throw e
+#else
+  #define BCLI_EXCEPTIONS 0
+  #define BCLI_THROW(e) bc::ex::fatal(e)
+#endif
+
 /**
  * @def ERROR_CTR
  * @ingroup Exceptions
@@ -352,6 +437,22 @@ ERROR_CLS(CmdModeError, ExitCodes::ImplError)
  */
 ERROR_CLS(AlreadyExistsError, ExitCodes::ImplError)
 
+/**
+ * @exception NotFrozenError
+ * @ingroup Exceptions
+ * @brief Thrown if a parser is used concurrently before Parser::freeze.
+ *
+ */
+ERROR_CLS(NotFrozenError, ExitCodes::ImplError)
+
+/**
+ * @exception PatternError
+ * @ingroup Exceptions
+ * @brief Thrown if a pattern given to check::f::match or check::f::glob is invalid.
+ *
+ */
+ERROR_CLS(PatternError, ExitCodes::ImplError)
+
 /**
  * @exception FileNotFoundError
  * @ingroup Exceptions
@@ -392,6 +493,14 @@ ERROR_CLS(MissingValueError, ExitCodes::UsageError)
  */
 ERROR_CLS(UnknownCmdError, ExitCodes::UsageError)
 
+/**
+ * @exception AmbiguousParamError
+ * @ingroup Exceptions
+ * @brief Thrown if an abbreviated long param matches several params.
+ *
+ */
+ERROR_CLS(AmbiguousParamError, ExitCodes::UsageError)
+
 /**
  * @exception RequiredParamError
  * @ingroup Exceptions
@@ -424,6 +533,14 @@ ERROR_CLS(BannedError, ExitCodes::UsageError)
  */
 ERROR_CLS(DependsError, ExitCodes::UsageError)
 
+/**
+ * @exception RelationError
+ * @ingroup Exceptions
+ * @brief Thrown if a relational constraint between two parameters is not satisfied.
+ *
+ */
+ERROR_CLS(RelationError, ExitCodes::UsageError)
+
 
 /**
  * @exception PositionalsError
@@ -433,6 +550,14 @@ ERROR_CLS(DependsError, ExitCodes::UsageError)
  */
 ERROR_CLS(PositionalsError, ExitCodes::UsageError)
 
+/**
+ * @exception DuplicateInputError
+ * @ingroup Exceptions
+ * @brief Thrown if the same file is given twice as input, see Command::dedup_inputs.
+ *
+ */
+ERROR_CLS(DuplicateInputError, ExitCodes::UsageError)
+
 /**
  * @brief LexicalCastError
  * @ingroup Exceptions
@@ -478,7 +603,7 @@ public:
     {
       for (auto& e : m_exceptions)
         std::cerr << "[" << e.get_name() << "]" << " -> " << e.get_msg() << std::endl;
-      throw BCliError("", "", Failure);
+      BCLI_THROW(BCliError("", "", Failure));
     }
   }
 
@@ -493,7 +618,7 @@ public:
     {
       BCliError e = m_exceptions.back();
       m_exceptions.pop_back();
-      throw e;
+      BCLI_THROW(e);
     }
   }
 
@@ -538,6 +663,15 @@ struct rwrapper<std::string_view> {using type = std::string;};
 template<typename RetType>
 using rwrapper_t = typename rwrapper<RetType>::type;
 
+template<typename>
+struct is_vector : std::false_type {};
+
+template<typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template<typename T>
+constexpr auto is_vector_v = is_vector<T>::value;
+
 enum class LexicalCast
 {
   from_str,
@@ -557,8 +691,8 @@ rwrapper_t<R> lexical_cast(const T& src)
     if (R ret; ss >> ret)
       return ret;
     else
-      throw ex::LexicalCastError(
-        "Unable to cast \"" + std::string(src) + "\" to " + std::string(typeid(R).name()));
+      BCLI_THROW(ex::LexicalCastError(
+        "Unable to cast \"" + std::string(src) + "\" to " + std::string(typeid(R).name())));
   }
   else if constexpr(mode == LexicalCast::to_str)
   {
@@ -597,6 +731,70 @@ auto lexical_cast(T&& src)
       return lexical_cast<R, T, LexicalCast::from_str>(std::forward<T>(src));
 }
 
+/**
+ * @ingroup Utilities
+ * @brief from_string
+ *
+ * Like lexical_cast<R>(std::string), but arithmetic types are converted with
+ * std::from_chars (no stream, no allocation).
+ *
+ * @tparam R
+ * @param s
+ * @return R
+ */
+template<typename R>
+R from_string(std::string_view s);
+
+/**
+ * @ingroup Utilities
+ * @brief try_from_string
+ *
+ * Non-throwing from_string for arithmetic and string types, other types fall back
+ * to from_string.
+ *
+ * @tparam R
+ * @param s
+ * @param out
+ * @return true on success
+ */
+template<typename R>
+bool try_from_string(std::string_view s, R& out)
+{
+  if constexpr(std::is_arithmetic_v<R> && !std::is_same_v<R, bool>)
+  {
+    const char* end = s.data() + s.size();
+    auto [ptr, ec] = std::from_chars(s.data(), end, out);
+    return ec == std::errc() && ptr == end;
+  }
+  else if constexpr(is_string_v<R>)
+  {
+    out = R(s);
+    return true;
+  }
+  else
+  {
+    out = from_string<R>(s);
+    return true;
+  }
+}
+
+template<typename R>
+R from_string(std::string_view s)
+{
+  if constexpr(std::is_arithmetic_v<R> && !std::is_same_v<R, bool>)
+  {
+    R ret {};
+    if (!try_from_string(s, ret))
+      BCLI_THROW(ex::LexicalCastError(
+        "Unable to cast \"" + std::string(s) + "\" to " + std::string(typeid(R).name())));
+    return ret;
+  }
+  else if constexpr(is_string_v<R>)
+    return R(s);
+  else
+    return lexical_cast<R>(std::string(s));
+}
+
 /**
  * @ingroup Utilities
  * @brief join
@@ -826,2348 +1024,7447 @@ inline std::vector<std::string> split(const std::string& s, char delim)
 
 /**
  * @ingroup Utilities
- * @brief is_long_param
+ * @brief FirstError
  *
- * @code
- * is_long_param("--param") -> true
- * @endcode
- * @param p a parameter
- * @return true if p starts with "--"
- * @return false
+ * Keeps the first exception thrown by work run on worker threads, to rethrow it on the
+ * calling thread once the workers are joined.
  */
-inline bool is_long_param(const std::string& p)
+class FirstError
 {
-  return p.rfind("--", 0) == 0;
-}
+public:
+  /**
+   * @brief call fn, an exception is stored instead of leaving the thread
+   *
+   * @tparam Fn void()
+   * @param fn
+   */
+  template<typename Fn>
+  void run(Fn&& fn) noexcept
+  {
+#if BCLI_EXCEPTIONS
+    try
+    {
+      fn();
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error)
+        m_error = std::current_exception();
+      m_failed = true;
+    }
+#else
+    fn();
+#endif
+  }
 
-/**
- * @ingroup Utilities
- * @brief is_short_param
- *
- * @code
- * is_short_param("-p") -> true
- * @endcode
- * @param p a parameter
- * @return true if p starts with "-"
- * @return false
- */
-inline bool is_short_param(const std::string& p)
-{
-  if (is_long_param(p))
-    return false;
-  return p.rfind("-", 0) == 0;
-}
+  bool failed() const { return m_failed; }
 
-/**
- * @ingroup Utilities
- * @brief is_param
- *
- * @param p a parameter
- * @return true if p starts with "-" or "--"
- * @return false
- */
-inline bool is_param(const std::string& p)
-{
-  return is_short_param(p) || is_long_param(p);
-}
+  void rethrow() const
+  {
+#if BCLI_EXCEPTIONS
+    if (m_error)
+      std::rethrow_exception(m_error);
+#endif
+  }
+
+PRIVATE:
+  std::mutex         m_mutex;
+  std::exception_ptr m_error {};
+  std::atomic<bool>  m_failed {false};
+};
 
 /**
  * @ingroup Utilities
- * @brief trim_param
+ * @brief start up to nb threads running fn, fewer if the system refuses to create more
  *
- * @code
- * trim_param("--param") -> "param"
- * @endcode
- * @param p a parameter to trim
- * @return std::string
+ * @param threads
+ * @param nb
+ * @param fn
  */
-inline std::string trim_param(const std::string& p)
+template<typename Fn>
+void spawn(std::vector<std::thread>& threads, size_t nb, Fn& fn)
 {
-  return ltrim(p, "-");
+  threads.reserve(nb);
+#if BCLI_EXCEPTIONS
+  try
+  {
+#endif
+    for (size_t t=0; t<nb; t++)
+      threads.emplace_back(fn);
+#if BCLI_EXCEPTIONS
+  }
+  catch (const std::system_error&)
+  {
+  }
+#endif
 }
 
 /**
  * @ingroup Utilities
- * @brief format_error
+ * @brief parallel_for
  *
- * @param p
- * @param v
- * @param m
- * @return std::string
+ * Call fn(i) for i in [0, n) on nb_threads threads. Indexes are claimed by chunks from
+ * a shared counter, so fast threads take over the work of slow ones. If fn throws, no
+ * more indexes are claimed and the first exception is rethrown once all threads joined.
+ *
+ * @tparam Fn void(size_t)
+ * @param n number of items
+ * @param nb_threads number of threads, 0 -> std::thread::hardware_concurrency()
+ * @param fn
+ * @param chunk chunk size
  */
-inline std::string format_error(const std::string& p, const std::string& v, const std::string& m)
+template<typename Fn>
+void parallel_for(size_t n, size_t nb_threads, Fn&& fn, size_t chunk = 16)
 {
-  std::stringstream ss;
-  ss << "[" << p << " " << v << "]" << " ~ " << m;
-  return ss.str();
+  if (nb_threads == 0)
+    nb_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  nb_threads = std::min(nb_threads, (n + chunk - 1) / chunk);
+
+  if (nb_threads <= 1)
+  {
+    for (size_t i=0; i<n; i++)
+      fn(i);
+    return;
+  }
+
+  std::atomic<size_t> next {0};
+  FirstError error;
+  auto worker = [&]() {
+    error.run([&]() {
+      for (size_t b = next.fetch_add(chunk); b < n && !error.failed(); b = next.fetch_add(chunk))
+        for (size_t i=b; i<std::min(b+chunk, n); i++)
+          fn(i);
+    });
+  };
+
+  std::vector<std::thread> threads;
+  spawn(threads, nb_threads - 1, worker);
+  worker();
+  for (auto& t : threads)
+    t.join();
+  error.rethrow();
 }
 
 /**
  * @ingroup Utilities
- * @brief  format_depend_errors
+ * @brief TaskPool
  *
- * @tparam T
- * @param p
- * @param d
- * @param msg
- * @return std::string
+ * A process-wide pool running background tasks, see Param::checker_async. Threads are
+ * started on demand, up to std::thread::hardware_concurrency(), and joined at exit.
+ * Unlike std::async, dropping a future doesn't wait for its task.
  */
-template<typename T>
-inline std::string format_depend_errors(T p, T d, const std::string& msg)
+class TaskPool
 {
-  std::stringstream ss;
-  ss << p->raw() << " " << p->value() << " depends on " << d->raw();
-  ss << " ~ " << "Check returns -> " << msg;
-  return ss.str();
-}
+public:
+  static TaskPool& get()
+  {
+    static TaskPool pool;
+    return pool;
+  }
+
+  /**
+   * @brief run fn on the pool
+   *
+   * @tparam Fn R()
+   * @param fn
+   * @return std::future<R>
+   */
+  template<typename Fn>
+  auto submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn>>
+  {
+    using R = std::invoke_result_t<Fn>;
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+    std::future<R> future = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.emplace_back([task]() { (*task)(); });
+      if (m_idle < m_tasks.size() && m_threads.size() < m_max)
+        spawn(m_threads, 1, m_worker);
+    }
+    m_cv.notify_one();
+    return future;
+  }
+
+  TaskPool(const TaskPool&) = delete;
+  TaskPool& operator=(const TaskPool&) = delete;
+
+  // queued tasks are dropped, their futures get a broken promise
+  ~TaskPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+      m_tasks.clear();
+    }
+    m_cv.notify_all();
+    for (auto& t : m_threads)
+      t.join();
+  }
+
+PRIVATE:
+  TaskPool() = default;
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+      m_idle++;
+      m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+      m_idle--;
+      if (m_stop)
+        return;
+      std::function<void()> task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::mutex                        m_mutex;
+  std::condition_variable           m_cv;
+  std::deque<std::function<void()>> m_tasks {};
+  std::vector<std::thread>          m_threads {};
+  std::function<void()>             m_worker {[this]() { run(); }};
+  size_t m_idle {0};
+  size_t m_max {std::max<size_t>(std::thread::hardware_concurrency(), 2)};
+  bool   m_stop {false};
+};
 
 /**
  * @ingroup Utilities
- * @brief format_banned_errors
+ * @brief Bitset
  *
- * @tparam T
- * @param p
- * @param d
- * @param msg
- * @return std::string
+ * A minimal dynamic bitset, used for constraint evaluation.
  */
-template<typename T>
-inline std::string format_banned_errors(T p, T d, const std::string& msg)
+class Bitset
 {
-  std::stringstream ss;
-  ss << p->raw() << " " << p->value() << " is banned with " << d->raw() << " " << d->value();
-  ss << " ~ " << "Check returns -> " << msg;
-  return ss.str();
-}
+public:
+  explicit Bitset(size_t n = 0) : m_words((n + 63) / 64, 0) {}
 
-class param_t;
-template<>
-inline std::string format_banned_errors(param_t, param_t, const std::string& msg);
+  void set(size_t i)
+  {
+    m_words[i >> 6] |= uint64_t{1} << (i & 63);
+  }
+
+  bool test(size_t i) const
+  {
+    return (m_words[i >> 6] >> (i & 63)) & 1;
+  }
+
+  /**
+   * @brief number of bits set in both bitsets
+   *
+   * @param other a bitset of the same size
+   * @return size_t
+   */
+  size_t count_and(const Bitset& other) const
+  {
+    size_t n = 0;
+    for (size_t i=0; i<m_words.size(); i++)
+      for (uint64_t w = m_words[i] & other.m_words[i]; w; w &= w - 1)
+        n++;
+    return n;
+  }
+
+PRIVATE:
+  std::vector<uint64_t> m_words;
+};
 
 /**
  * @ingroup Utilities
- * @brief valid_string
+ * @brief Dfa
+ *
+ * A regex (or glob) compiled into a deterministic automaton, matches the whole value in
+ * linear time and without allocation.
+ *
+ * Regex syntax: literals, '.', [a-z] and [^a-z] classes, \d \w \s (and \D \W \S),
+ * groups, '|', '*', '+', '?', {n}, {n,} and {n,m}. Glob syntax: '*', '?', [a-z], [!a-z]
+ * and {a,b}.
  *
  * @code
- * auto validator = [](const char& c) -> bool {
- *   if (c == 'A' || c == 'C' || c == 'T' || c == 'G')
- *     return true;
- *   return false;
- * };
- * valid_string("ACGTTTACGA", validator);
+ * utils::Dfa sample("[A-Z]{2}[0-9]{4}(_R[12])?");
+ * sample.match("AB1234_R1"); // -> true
+ * utils::Dfa::from_glob("*.fa").match("ref.fa"); // -> true
  * @endcode
- * @tparam std::function<bool(const char&)>
- * @param s
- * @param valid
- * @return true if s is valid
- * @return false if s is invalid
  */
-template<typename Validator = std::function<bool(const char&)>>
-bool valid_string(const std::string& s, Validator valid)
+class Dfa
 {
-  for (const char& c : s)
-    if (!valid(c))
+  using charset_t = std::array<bool, 256>;
+
+  struct NfaState
+  {
+    std::vector<int> eps {};
+    std::vector<std::pair<int, int>> edges {}; // (charset index, target)
+  };
+
+  struct Fragment
+  {
+    int start;
+    int end;
+  };
+
+public:
+  Dfa() = default;
+
+  explicit Dfa(std::string_view regex)
+  {
+    compile(regex);
+  }
+
+  /**
+   * @brief compile a glob pattern
+   *
+   * @param glob
+   * @return Dfa
+   */
+  static Dfa from_glob(std::string_view glob)
+  {
+    std::string regex;
+    int braces = 0;
+    for (size_t i=0; i<glob.size(); i++)
+    {
+      char c = glob[i];
+      if (c == '*')
+        regex += ".*";
+      else if (c == '?')
+        regex += '.';
+      else if (c == '[')
+      {
+        size_t j = glob.find(']', i + 2);
+        if (j == std::string_view::npos)
+          BCLI_THROW(ex::PatternError("Unterminated '[' in glob " + std::string(glob) + "."));
+        std::string_view cls = glob.substr(i + 1, j - i - 1);
+        regex += '[';
+        regex += cls[0] == '!' ? std::string("^") + std::string(cls.substr(1)) : std::string(cls);
+        regex += ']';
+        i = j;
+      }
+      else if (c == '{')
+      {
+        regex += "(";
+        braces++;
+      }
+      else if (c == ',' && braces)
+        regex += '|';
+      else if (c == '}' && braces)
+      {
+        regex += ')';
+        braces--;
+      }
+      else
+      {
+        if (std::strchr("\\.+()|^$", c))
+          regex += '\\';
+        regex += c;
+      }
+    }
+    return Dfa(regex);
+  }
+
+  /**
+   * @brief match the whole value
+   *
+   * @param v
+   * @return true if v matches the pattern
+   */
+  bool match(std::string_view v) const
+  {
+    if (m_accept.empty())
       return false;
-  return true;
-}
+    int32_t s = 0;
+    for (unsigned char c : v)
+    {
+      s = m_table[s * m_nb_classes + m_classes[c]];
+      if (s < 0)
+        return false;
+    }
+    return m_accept[s];
+  }
 
-/**
- * @ingroup Utilities
- * @brief sp
- *
- * @param n
- * @return std::string
- */
-inline std::string sp(int n)
-{
-  return std::string(n, ' ');
-}
+  size_t size() const
+  {
+    return m_accept.size();
+  }
 
-/**
- * @ingroup Utilities
- * @brief exit_bcli
- *
- * @param e
- */
-inline void exit_bcli(const ex::BCliError& e)
-{
-  if (!e.get_name().empty())
-    std::cerr << wrap(e.get_name(), "[]") << " -> " << e.get_msg() << std::endl;
-}
+PRIVATE:
+  void compile(std::string_view regex)
+  {
+    m_pattern = regex;
+    m_pos = 0;
+    if (!m_pattern.empty() && m_pattern.front() == '^')
+      m_pos = 1;
+    Fragment f = parse_alt();
+    if (!at_end())
+      error("unexpected ')'");
+    build(f);
+    m_nfa.clear();
+    m_sets.clear();
+  }
 
-} // end of namespace utils
+  [[noreturn]] void error(const std::string& msg) const
+  {
+    BCLI_THROW(ex::PatternError("Invalid pattern " + m_pattern + ": " + msg + "."));
+    std::abort();
+  }
 
-/**
- * @defgroup Checkers
- * @brief About bcli checkers.
- *
- * Checkers are functions used to parameter value validation.
- * A checker take two parameters:
- *  - an id, usually a parameter (ex: "--param")
- *  - a value to check
- *
- * And returns a std::tuple<bool, std::string>
- *  - 0: true if check success, false otherwise
- *  - 1: An error message
- *
- * Two namespaces:
- *  - check -> contains checkers
- *  - check::f -> contains factories
- *
- */
+  bool at_end() const
+  {
+    return m_pos >= m_pattern.size() ||
+           (m_pattern[m_pos] == '$' && m_pos + 1 == m_pattern.size());
+  }
 
-/**
- * @namespace check
- * @ingroup Checkers
- * @brief bcli check namespace
- *
- */
-namespace check {
+  int new_state()
+  {
+    m_nfa.emplace_back();
+    return static_cast<int>(m_nfa.size()) - 1;
+  }
 
-/**
- * @typedef checker_ret_t
- * @ingroup Checkers
- * @brief checkers return type
- *
- */
-using checker_ret_t = std::tuple<bool, std::string>;
+  Fragment empty()
+  {
+    int s = new_state();
+    return {s, s};
+  }
 
-/**
- * @typedef checker_fn_t
- * @ingroup Checkers
- * @brief checkers function signature
- *
- */
-using checker_fn_t = std::function<checker_ret_t(const std::string&, const std::string&)>;
+  Fragment atom(const charset_t& set)
+  {
+    int s = new_state(), e = new_state();
+    m_sets.push_back(set);
+    m_nfa[s].edges.emplace_back(static_cast<int>(m_sets.size()) - 1, e);
+    return {s, e};
+  }
+
+  Fragment concat(Fragment a, Fragment b)
+  {
+    m_nfa[a.end].eps.push_back(b.start);
+    return {a.start, b.end};
+  }
+
+  Fragment repeat(Fragment a, bool zero, bool many)
+  {
+    int s = new_state(), e = new_state();
+    m_nfa[s].eps.push_back(a.start);
+    if (zero)
+      m_nfa[s].eps.push_back(e);
+    if (many)
+      m_nfa[a.end].eps.push_back(a.start);
+    m_nfa[a.end].eps.push_back(e);
+    return {s, e};
+  }
 
+  Fragment parse_alt()
+  {
+    Fragment f = parse_concat();
+    while (m_pos < m_pattern.size() && m_pattern[m_pos] == '|')
+    {
+      m_pos++;
+      Fragment g = parse_concat();
+      int s = new_state(), e = new_state();
+      m_nfa[s].eps = {f.start, g.start};
+      m_nfa[f.end].eps.push_back(e);
+      m_nfa[g.end].eps.push_back(e);
+      f = {s, e};
+    }
+    return f;
+  }
+
+  Fragment parse_concat()
+  {
+    Fragment f = empty();
+    while (!at_end() && m_pattern[m_pos] != '|' && m_pattern[m_pos] != ')')
+      f = concat(f, parse_repeat());
+    return f;
+  }
+
+  Fragment parse_repeat()
+  {
+    size_t begin = m_pos;
+    Fragment f = parse_atom();
+    if (at_end())
+      return f;
+    char q = m_pattern[m_pos];
+    if (q == '*' || q == '+' || q == '?')
+    {
+      m_pos++;
+      f = repeat(f, q != '+', q != '?');
+    }
+    else if (q == '{')
+    {
+      size_t close = m_pattern.find('}', m_pos);
+      if (close == std::string::npos)
+        error("unterminated '{'");
+      std::string_view bounds(m_pattern.data() + m_pos + 1, close - m_pos - 1);
+      size_t comma = bounds.find(',');
+      size_t lo = 0, hi = 0;
+      bool ok = utils::try_from_string(bounds.substr(0, comma), lo);
+      if (comma == std::string_view::npos)
+        hi = lo;
+      else if (comma + 1 == bounds.size())
+        hi = std::string::npos;
+      else
+        ok = ok && utils::try_from_string(bounds.substr(comma + 1), hi);
+      if (!ok || hi < lo || (hi != std::string::npos && hi > 1000))
+        error("invalid repetition {" + std::string(bounds) + "}");
+      m_pos = close + 1;
+
+      // expand by re-parsing the atom, ex: a{2,3} -> aa(a)?
+      auto copy = [&]() {
+        size_t pos = m_pos;
+        m_pos = begin;
+        Fragment c = parse_atom();
+        m_pos = pos;
+        return c;
+      };
+      bool unbounded = hi == std::string::npos;
+      Fragment r = f;
+      if (lo == 0)
+        r = hi == 0 ? empty() : repeat(f, true, unbounded);
+      for (size_t i=1; i<lo; i++)
+        r = concat(r, copy());
+      if (lo && unbounded)
+        r = concat(r, repeat(copy(), true, true));
+      for (size_t i=std::max<size_t>(lo, 1); !unbounded && i<hi; i++)
+        r = concat(r, repeat(copy(), true, false));
+      f = r;
+    }
+    else
+      return f;
+    if (!at_end() && std::strchr("*+?{", m_pattern[m_pos]))
+      error("nested quantifier");
+    return f;
+  }
+
+  void add_escape(charset_t& set, char c) const
+  {
+    auto add_if = [&set](auto pred, bool negate) {
+      for (int b=0; b<256; b++)
+        if (static_cast<bool>(pred(b)) != negate)
+          set[b] = true;
+    };
+    switch (c)
+    {
+      case 'd': add_if(::isdigit, false); break;
+      case 'D': add_if(::isdigit, true); break;
+      case 'w': add_if([](int b) { return std::isalnum(b) || b == '_'; }, false); break;
+      case 'W': add_if([](int b) { return std::isalnum(b) || b == '_'; }, true); break;
+      case 's': add_if(::isspace, false); break;
+      case 'S': add_if(::isspace, true); break;
+      case 't': set['\t'] = true; break;
+      case 'n': set['\n'] = true; break;
+      default: set[static_cast<unsigned char>(c)] = true;
+    }
+  }
+
+  Fragment parse_atom()
+  {
+    charset_t set {};
+    char c = m_pattern[m_pos++];
+    switch (c)
+    {
+      case '(':
+      {
+        if (m_pattern.compare(m_pos, 2, "?:") == 0)
+          m_pos += 2;
+        Fragment f = parse_alt();
+        if (m_pos >= m_pattern.size() || m_pattern[m_pos] != ')')
+          error("missing ')'");
+        m_pos++;
+        return f;
+      }
+      case '[':
+        parse_class(set);
+        break;
+      case '.':
+        set.fill(true);
+        break;
+      case '\\':
+        if (m_pos >= m_pattern.size())
+          error("trailing '\\'");
+        add_escape(set, m_pattern[m_pos++]);
+        break;
+      case '*': case '+': case '?': case '{':
+        error(std::string("nothing to repeat before '") + c + "'");
+      default:
+        set[static_cast<unsigned char>(c)] = true;
+    }
+    return atom(set);
+  }
+
+  void parse_class(charset_t& set)
+  {
+    bool negate = m_pos < m_pattern.size() && m_pattern[m_pos] == '^';
+    if (negate)
+      m_pos++;
+    bool first = true;
+    while (true)
+    {
+      if (m_pos >= m_pattern.size())
+        error("missing ']'");
+      unsigned char c = m_pattern[m_pos++];
+      if (c == ']' && !first)
+        break;
+      first = false;
+      if (c == '\\' && m_pos < m_pattern.size())
+      {
+        add_escape(set, m_pattern[m_pos++]);
+        continue;
+      }
+      unsigned char hi = c;
+      if (m_pos + 1 < m_pattern.size() && m_pattern[m_pos] == '-' && m_pattern[m_pos + 1] != ']')
+      {
+        hi = m_pattern[m_pos + 1];
+        m_pos += 2;
+        if (hi < c)
+          error("invalid range in class");
+      }
+      for (int b=c; b<=hi; b++)
+        set[b] = true;
+    }
+    if (negate)
+      for (auto& b : set)
+        b = !b;
+  }
+
+  void closure(std::vector<int>& states) const
+  {
+    std::vector<bool> seen(m_nfa.size(), false);
+    for (int s : states)
+      seen[s] = true;
+    for (size_t i=0; i<states.size(); i++)
+      for (int t : m_nfa[states[i]].eps)
+        if (!seen[t])
+        {
+          seen[t] = true;
+          states.push_back(t);
+        }
+    std::sort(states.begin(), states.end());
+  }
+
+  void build(Fragment f)
+  {
+    // bytes matched by the same charsets share a class
+    std::map<std::vector<bool>, uint8_t> classes;
+    std::vector<unsigned char> repr;
+    for (int b=0; b<256; b++)
+    {
+      std::vector<bool> sig(m_sets.size());
+      for (size_t i=0; i<m_sets.size(); i++)
+        sig[i] = m_sets[i][b];
+      auto it = classes.emplace(sig, static_cast<uint8_t>(classes.size())).first;
+      if (it->second == repr.size())
+        repr.push_back(static_cast<unsigned char>(b));
+      m_classes[b] = it->second;
+    }
+    m_nb_classes = repr.size();
+
+    // subset construction
+    std::map<std::vector<int>, int32_t> ids;
+    std::vector<std::vector<int>> todo;
+    auto add = [&](std::vector<int> states) -> int32_t {
+      if (states.empty())
+        return -1;
+      closure(states);
+      auto [it, inserted] = ids.emplace(states, static_cast<int32_t>(ids.size()));
+      if (inserted)
+      {
+        if (ids.size() > 10000)
+          error("too many states");
+        m_accept.push_back(std::binary_search(states.begin(), states.end(), f.end));
+        m_table.resize(m_table.size() + m_nb_classes, -1);
+        todo.push_back(std::move(states));
+      }
+      return it->second;
+    };
+    add({f.start});
+    for (size_t d=0; d<todo.size(); d++)
+    {
+      for (size_t k=0; k<m_nb_classes; k++)
+      {
+        std::vector<int> next;
+        for (int s : todo[d])
+          for (auto& [set, t] : m_nfa[s].edges)
+            if (m_sets[set][repr[k]])
+              next.push_back(t);
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        int32_t id = add(std::move(next));
+        m_table[d * m_nb_classes + k] = id;
+      }
+    }
+  }
+
+PRIVATE:
+  std::array<uint8_t, 256> m_classes {};
+  size_t                   m_nb_classes {0};
+  std::vector<int32_t>     m_table {};
+  std::vector<uint8_t>     m_accept {};
+
+  // compilation only
+  std::string           m_pattern {};
+  size_t                m_pos {0};
+  std::vector<NfaState> m_nfa {};
+  std::vector<charset_t> m_sets {};
+};
 
 /**
- * @ingroup Checkers
- * @brief throw ex::CheckFailedError if checker returns false
+ * @ingroup Utilities
+ * @brief edit distance between a and b, bounded by max
  *
- * ex: throw_if_false(check::is_number("--integer", "10"));
+ * Bit-parallel (Myers/Hyyrö) for |a| <= 64, O(|b|) words operations.
+ *
+ * @code
+ * edit_distance("--kmr", "--kmer", 2); // -> 1
+ * @endcode
+ * @param a
+ * @param b
+ * @param max
+ * @return size_t the distance, or max + 1 if it is greater than max
  */
-inline void throw_if_false(const checker_ret_t& rc)
+inline size_t edit_distance(std::string_view a, std::string_view b, size_t max)
 {
-  if (!std::get<0>(rc))
-    throw ex::CheckFailedError(std::get<1>(rc));
+  size_t m = a.size();
+  size_t n = b.size();
+  if ((m > n ? m - n : n - m) > max)
+    return max + 1;
+  if (m == 0)
+    return n;
+  if (m > 64)
+    return a == b ? 0 : max + 1;
+
+  std::array<uint64_t, 256> peq {};
+  for (size_t i=0; i<m; i++)
+    peq[static_cast<unsigned char>(a[i])] |= uint64_t{1} << i;
+
+  uint64_t last = uint64_t{1} << (m - 1);
+  uint64_t pv = m == 64 ? ~uint64_t{0} : (uint64_t{1} << m) - 1;
+  uint64_t mv = 0;
+  size_t score = m;
+  for (size_t j=0; j<n; j++)
+  {
+    uint64_t eq = peq[static_cast<unsigned char>(b[j])];
+    uint64_t xv = eq | mv;
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    if (ph & last)
+      score++;
+    else if (mh & last)
+      score--;
+    ph = (ph << 1) | 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    if (score > max + (n - j - 1))
+      return max + 1;
+  }
+  return score > max ? max + 1 : score;
 }
 
-// Shortcut to define a new checker
 /**
- * @ingroup Checkers
- * @def DEFINE_CHECKER
- * @brief define a new checker
+ * @ingroup Utilities
+ * @brief NameIndex
+ *
+ * Names sorted by length, to find the nearest ones to a typo.
  */
-#define DEFINE_CHECKER(name, s1, s2)                                        \
-  inline checker_ret_t name(const std::string& s1, const std::string& s2)   \
+class NameIndex
+{
+public:
+  void add(const std::string& name)
+  {
+    if (!name.empty())
+      m_names.push_back(name);
+  }
 
+  void freeze()
+  {
+    std::stable_sort(m_names.begin(), m_names.end(),
+      [](const std::string& a, const std::string& b) { return a.size() < b.size(); });
+  }
 
-DEFINE_CHECKER(always_true, p, v)
-{
-  unused(p);
-  unused(v);
-  return std::make_tuple(true, "A true checker.");
-}
+  /**
+   * @brief nearest names to query, only looks at names of a close length
+   *
+   * @param query
+   * @param max max edit distance, default to a third of the query length (1 to 3),
+   *            always below the length of the query without its dashes
+   * @return std::vector<std::string> the names at the smallest distance
+   */
+  std::vector<std::string> suggest(std::string_view query, size_t max = 0) const
+  {
+    if (!max)
+      max = std::clamp<size_t>(query.size() / 3, 1, 3);
+    // rewriting the whole name is not a typo, e.g. -x for -k
+    size_t body = query.size() - std::min(query.find_first_not_of('-'), query.size());
+    if (body <= 1)
+      return {};
+    max = std::min(max, body - 1);
+    size_t lo = query.size() > max ? query.size() - max : 0;
+    auto it = std::lower_bound(m_names.begin(), m_names.end(), lo,
+      [](const std::string& s, size_t len) { return s.size() < len; });
+
+    std::vector<std::string> best;
+    size_t best_dist = max + 1;
+    for (; it != m_names.end() && it->size() <= query.size() + max; ++it)
+    {
+      size_t d = edit_distance(query, *it, std::min(max, best_dist));
+      if (d < best_dist)
+      {
+        best_dist = d;
+        best.clear();
+      }
+      if (d == best_dist && d <= max)
+        best.push_back(*it);
+    }
+    return best;
+  }
+
+PRIVATE:
+  std::vector<std::string> m_names {};
+};
 
 /**
- * @ingroup Checkers
- * @brief is_file checker
- *
- * Return true if v corresponds to a file.
- *
- * ex: check::is_file("--param", "/path/to/file.txt");
+ * @ingroup Utilities
+ * @brief RadixTrie
  *
- * @param p parameter as string (ex: "--param")
- * @param v parameter value
+ * A radix trie over a set of names, to resolve unique prefixes in O(prefix length).
  *
- * @return std::tuple<bool, std::string>
+ * @code
+ * RadixTrie t;
+ * t.insert("count-abundance-min");
+ * t.insert("count-abundance-max");
+ * t.insert("threads");
+ * t.freeze();
+ * t.complete("th"); // -> {"threads"}
+ * t.complete("count-ab"); // -> {"count-abundance-min", "count-abundance-max"}
+ * @endcode
  */
-DEFINE_CHECKER(is_file, p, v)
+class RadixTrie
 {
-  bool exists = fs::exists(v);
-  return std::make_tuple(exists, utils::format_error(p, v, "File doesn't exist!"));
-}
+  struct Node
+  {
+    std::string           label {};
+    std::vector<uint32_t> children {};
+    int32_t               key {-1};  // key ending at this node
+    int32_t               any {-1};  // a key of the subtree
+    uint32_t              count {0}; // number of keys in the subtree
+  };
 
-/**
- * @ingroup Checkers
- * @brief is_dir checker
- *
- * Return true if v corresponds to a directory.
- *
- * ex: check::is_dir("--param", "/path/to/dir");
- *
- * @param p parameter as string (ex: "--param")
- * @param v parameter value
- *
- * @return std::tuple<bool, std::string>
- */
-DEFINE_CHECKER(is_dir, p, v)
-{
-  bool exists = fs::is_directory(v);
-  return std::make_tuple(exists, utils::format_error(p, v, "Directory doesn't exist!"));
-}
+public:
+  RadixTrie() : m_nodes(1) {}
 
-/**
- * @ingroup Checkers
- * @brief is_number checker
- *
- * Return true if v corresponds to a number.
- *
- * ex: check::is_number("--param", "10");
- *
- * @param p parameter as string (ex: "--file")
- * @param v parameter value
- *
- * @return std::tuple<bool, std::string>
- */
-DEFINE_CHECKER(is_number, p, v)
-{
-  bool is = true;
-  bool neg = false;
-  for (const char& c : v)
+  void insert(const std::string& key)
   {
-    if (!neg && c == '-')
+    uint32_t n = 0;
+    size_t i = 0;
+    while (i < key.size())
     {
-      neg = true;
-      continue;
+      uint32_t next = find_child(n, key[i]);
+      if (next == 0)
+      {
+        m_nodes.emplace_back();
+        m_nodes.back().label = key.substr(i);
+        next = static_cast<uint32_t>(m_nodes.size() - 1);
+        m_nodes[n].children.push_back(next);
+        n = next;
+        i = key.size();
+        break;
+      }
+      const std::string& label = m_nodes[next].label;
+      size_t common = 0;
+      while (common < label.size() && i + common < key.size() && label[common] == key[i + common])
+        common++;
+      if (common < label.size())
+      {
+        // split the edge: n -> mid -> next
+        Node mid;
+        mid.label = label.substr(0, common);
+        mid.children.push_back(next);
+        m_nodes[next].label.erase(0, common);
+        m_nodes.push_back(std::move(mid));
+        uint32_t mid_id = static_cast<uint32_t>(m_nodes.size() - 1);
+        std::replace(m_nodes[n].children.begin(), m_nodes[n].children.end(), next, mid_id);
+        next = mid_id;
+      }
+      n = next;
+      i += common;
     }
-    if (!std::isdigit(c) && c != '.')
+    if (m_nodes[n].key < 0)
     {
-      is = false;
-      break;
+      m_nodes[n].key = static_cast<int32_t>(m_keys.size());
+      m_keys.push_back(key);
     }
   }
-  if (v.empty()) is = false;
-  return std::make_tuple(is, utils::format_error(p, v, "Not a number!"));
-}
 
-/**
- * @ingroup Checkers
- * @brief is_dna checker
- *
- * Return true if v corresponds to a dna string.
- *
- * ex: check::is_dna("--param", "ACGACGA");
- *
- * @param p parameter as string (ex: "--param")
- * @param v parameter value
- *
- * @return std::tuple<bool, std::string>
- */
-DEFINE_CHECKER(is_dna, p, v)
-{
-  auto valid_nt = [](const char& c) -> bool {
-    switch (c)
+  /**
+   * @brief compute subtree counts, to call once all keys are inserted
+   */
+  void freeze()
+  {
+    count(0);
+  }
+
+  /**
+   * @brief keys starting with prefix
+   *
+   * Returns the key itself if it exists, a single key in O(prefix length) if the prefix
+   * is unique, otherwise all the candidates.
+   *
+   * @param prefix
+   * @return std::vector<std::string>
+   */
+  std::vector<std::string> complete(std::string_view prefix) const
+  {
+    uint32_t n = 0;
+    size_t i = 0;
+    bool exact = true;
+    while (i < prefix.size())
     {
-      case 'A': return true;
-      case 'C': return true;
-      case 'T': return true;
-      case 'G': return true;
-      default: return false;
+      n = find_child(n, prefix[i]);
+      if (n == 0)
+        return {};
+      const std::string& label = m_nodes[n].label;
+      size_t len = std::min(label.size(), prefix.size() - i);
+      if (prefix.compare(i, len, label, 0, len) != 0)
+        return {};
+      exact = len == label.size();
+      i += len;
     }
-  };
-  return std::make_tuple(utils::valid_string(v, valid_nt),
-                         utils::format_error(p, v, "Not a valid dna string."));
-}
+    const Node& node = m_nodes[n];
+    if (exact && node.key >= 0)
+      return {m_keys[node.key]};
+    if (node.count == 1)
+      return {m_keys[node.any]};
+    std::vector<std::string> ret;
+    collect(n, ret);
+    return ret;
+  }
+
+PRIVATE:
+  uint32_t find_child(uint32_t n, char c) const
+  {
+    for (uint32_t child : m_nodes[n].children)
+      if (m_nodes[child].label[0] == c)
+        return child;
+    return 0;
+  }
+
+  uint32_t count(uint32_t n)
+  {
+    uint32_t total = m_nodes[n].key >= 0;
+    int32_t any = m_nodes[n].key;
+    for (uint32_t child : m_nodes[n].children)
+    {
+      total += count(child);
+      if (any < 0)
+        any = m_nodes[child].any;
+    }
+    m_nodes[n].count = total;
+    m_nodes[n].any = any;
+    return total;
+  }
+
+  void collect(uint32_t n, std::vector<std::string>& out) const
+  {
+    if (m_nodes[n].key >= 0)
+      out.push_back(m_keys[m_nodes[n].key]);
+    for (uint32_t child : m_nodes[n].children)
+      collect(child, out);
+  }
+
+PRIVATE:
+  std::vector<Node>        m_nodes;
+  std::vector<std::string> m_keys {};
+};
 
 /**
- * @ingroup Checkers
- * @brief is_number checker
- *
- * Return true if v corresponds to a rna string.
+ * @ingroup Utilities
+ * @brief FrontCodedStore
  *
- * ex: check::is_rna("--param", "10");
+ * An append-only list of strings, front-coded in a single buffer: each string is stored
+ * as the length of the prefix it shares with the previous one, plus the rest. Every
+ * FrontCodedStore::bucket strings, a string is stored in full, for random access.
+ * Paths sharing long directory prefixes take a fraction of a std::vector<std::string>.
  *
- * @param p parameter as string (ex: "--param")
- * @param v parameter value
+ * @code
+ * FrontCodedStore s;
+ * s.push_back("/data/run1/sample_1.fq.gz");
+ * s.push_back("/data/run1/sample_2.fq.gz"); // stored as (23, "2.fq.gz")
+ * std::string buf;
+ * s.get(1, buf); // -> "/data/run1/sample_2.fq.gz", in buf
+ * for (const std::string& path : s) // decodes in a buffer owned by the iterator
+ *   ...
+ * @endcode
  *
- * @return std::tuple<bool, std::string>
+ * Iterators are input iterators: a reference is only valid until the iterator moves.
  */
-DEFINE_CHECKER(is_rna, p, v)
+class FrontCodedStore
 {
-  auto valid_nt = [](const char& c) -> bool {
-    switch (c)
+public:
+  static constexpr size_t bucket = 16;
+
+  class iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::string;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string*;
+    using reference = const std::string&;
+
+    const std::string& operator*() const { return m_buffer; }
+    const std::string* operator->() const { return &m_buffer; }
+
+    iterator& operator++()
     {
-      case 'A': return true;
-      case 'C': return true;
-      case 'U': return true;
-      case 'G': return true;
-      default: return false;
+      if (++m_index < m_store->size())
+        m_pos = m_store->decode(m_pos, m_buffer);
+      return *this;
+    }
+
+    bool operator==(const iterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+
+  PRIVATE:
+    friend class FrontCodedStore;
+
+    // decoding is sequential, only begin() and end() are valid positions
+    iterator(const FrontCodedStore* store, size_t index)
+      : m_store(store), m_index(index)
+    {
+      assert(m_index == 0 || m_index == m_store->size());
+      if (m_index < m_store->size())
+        m_pos = m_store->decode(0, m_buffer);
     }
+
+    const FrontCodedStore* m_store;
+    size_t                 m_index;
+    size_t                 m_pos {0};
+    std::string            m_buffer {};
   };
-  return std::make_tuple(utils::valid_string(v, valid_nt),
-                         utils::format_error(p, v, "Not a valid rna string."));
-}
 
-/**
- * @namespace f
- * @ingroup Checkers
- * @brief bcli checker factories namespace
- *
- * Checker factories are function that return check::checker_fn_t.
- * This allows configurable checkers.
- *
- */
-namespace f {
+  void push_back(std::string_view s)
+  {
+    size_t lcp = 0;
+    if (m_size % bucket == 0)
+      m_buckets.push_back(m_data.size());
+    else
+      while (lcp < s.size() && lcp < m_last.size() && s[lcp] == m_last[lcp])
+        lcp++;
+    put_varint(lcp);
+    put_varint(s.size() - lcp);
+    m_data.insert(m_data.end(), s.begin() + lcp, s.end());
+    m_last.assign(s);
+    m_size++;
+  }
+
+  /**
+   * @brief decode the i-th string in buffer, O(bucket) decoding steps
+   *
+   * @param i
+   * @param buffer
+   * @return std::string_view on buffer
+   */
+  std::string_view get(size_t i, std::string& buffer) const
+  {
+    size_t pos = m_buckets[i / bucket];
+    for (size_t j=0; j<=i % bucket; j++)
+      pos = decode(pos, buffer);
+    return buffer;
+  }
+
+  std::string operator[](size_t i) const
+  {
+    std::string buffer;
+    get(i, buffer);
+    return buffer;
+  }
+
+  std::string back() const
+  {
+    return m_last;
+  }
+
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  /**
+   * @brief memory used by the encoded strings, in bytes
+   */
+  size_t bytes() const
+  {
+    return m_data.size() + m_buckets.size() * sizeof(size_t);
+  }
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, m_size); }
+
+  void clear()
+  {
+    m_data.clear();
+    m_buckets.clear();
+    m_last.clear();
+    m_size = 0;
+  }
+
+  std::vector<std::string> to_vector() const
+  {
+    std::vector<std::string> ret;
+    ret.reserve(m_size);
+    for (std::string_view s : *this)
+      ret.emplace_back(s);
+    return ret;
+  }
+
+  operator std::vector<std::string>() const
+  {
+    return to_vector();
+  }
+
+  friend bool operator==(const FrontCodedStore& store, const std::vector<std::string>& v)
+  {
+    return store.size() == v.size() && std::equal(store.begin(), store.end(), v.begin());
+  }
+
+  friend bool operator==(const std::vector<std::string>& v, const FrontCodedStore& store)
+  {
+    return store == v;
+  }
+
+  friend bool operator!=(const FrontCodedStore& store, const std::vector<std::string>& v)
+  {
+    return !(store == v);
+  }
+
+  friend bool operator!=(const std::vector<std::string>& v, const FrontCodedStore& store)
+  {
+    return !(store == v);
+  }
+
+PRIVATE:
+  void put_varint(size_t v)
+  {
+    for (; v >= 0x80; v >>= 7)
+      m_data.push_back(static_cast<char>((v & 0x7f) | 0x80));
+    m_data.push_back(static_cast<char>(v));
+  }
+
+  size_t get_varint(size_t& pos) const
+  {
+    size_t v = 0;
+    for (int shift = 0;; shift += 7)
+    {
+      uint8_t b = static_cast<uint8_t>(m_data[pos++]);
+      v |= static_cast<size_t>(b & 0x7f) << shift;
+      if (!(b & 0x80))
+        return v;
+    }
+  }
+
+  // decode the string at pos, front-coded against buffer, returns the next pos
+  size_t decode(size_t pos, std::string& buffer) const
+  {
+    size_t lcp = get_varint(pos);
+    size_t len = get_varint(pos);
+    buffer.resize(lcp);
+    buffer.append(m_data.data() + pos, len);
+    return pos + len;
+  }
+
+PRIVATE:
+  std::vector<char>   m_data {};
+  std::vector<size_t> m_buckets {};
+  std::string         m_last {};
+  size_t              m_size {0};
+};
 
 /**
- * @ingroup Checkers
- * @brief extension checker factory
+ * @ingroup Utilities
+ * @brief is_long_param
  *
  * @code
- * auto seems_fasta = check::f::ext("fa|fna");
- * throw_if_false(seems_fasta("--param", "/path/to/file.fasta"));
+ * is_long_param("--param") -> true
  * @endcode
- * @param ext A set of extensions as string, sep by '|'.
- * @return checker_fn_t
+ * @param p a parameter
+ * @return true if p starts with "--"
+ * @return false
  */
-inline checker_fn_t ext(const std::string& ext)
+inline bool is_long_param(const std::string& p)
 {
-  return [ext](const std::string& p, const std::string&v) -> checker_ret_t {
-    std::vector<std::string> exts = utils::split(ext, '|');
-    auto error_msg = std::bind(&utils::format_error, p, v, std::placeholders::_1);
-    if (!fs::path(v).has_extension())
-      return std::make_tuple(false, error_msg("No extension."));
-    else
-    {
-      if (std::any_of(exts.begin(), exts.end(), std::bind(&utils::endswith, v, std::placeholders::_1)))
-      {
-        return std::make_tuple<bool, std::string>(true, {});
-      }
-      else
-      {
-        std::string extp = fs::path(v).extension();
-        return std::make_tuple(false, error_msg(extp + "!=" + ext));
-      }
-    }
-  };
+  return p.rfind("--", 0) == 0;
 }
 
 /**
- * @ingroup Checkers
- * @brief range checker factory
+ * @ingroup Utilities
+ * @brief is_short_param
+ *
  * @code
- * auto in_10_100 = check::range(10, 100);
- * throw_if_false(in_10_100("--param", "42"));
+ * is_short_param("-p") -> true
  * @endcode
- * @tparam T An arithmetic type
- * @tparam std::enable_if_t<std::is_arithmetic_v<T>, void>
- * @param start lower bound
- * @param end upper bound
- * @return checker_fn_t
+ * @param p a parameter
+ * @return true if p starts with "-"
+ * @return false
  */
-template<typename T,
-         typename = typename std::enable_if_t<std::is_arithmetic_v<T>, void>>
-inline checker_fn_t range(T start, T end)
+inline bool is_short_param(const std::string& p)
 {
-  return [start, end](const std::string& p, const std::string& v) -> checker_ret_t {
-    throw_if_false(is_number(p, v));
-    T value;
-    if constexpr(std::is_floating_point_v<T>)
-      value = std::stod(v);
-    else if (std::is_integral_v<T>)
-      value = std::stoi(v);
-    bool in_range = (value >= start) && (value <= end);
-    return std::make_tuple(in_range, utils::format_error(
-      p, v, "Not in range [" + std::to_string(start) + "," + std::to_string(end) +"]."));
-  };
+  if (is_long_param(p))
+    return false;
+  return p.rfind("-", 0) == 0;
 }
 
 /**
- * @ingroup Checkers
- * @brief in checker factory
- * @code
- * auto is_valid_cmd = in("cmd2|cmd3");
- * throw_if_false(is_valid_cmd("--param", "cmd3"));
- * @endcode
- * @param s A set of strings as one string, sep by '|'.
- * @return checker_fn_t
+ * @ingroup Utilities
+ * @brief is_param
+ *
+ * @param p a parameter
+ * @return true if p starts with "-" or "--"
+ * @return false
  */
-inline checker_fn_t in(const std::string& s)
+inline bool is_param(const std::string& p)
 {
-  return [s](const std::string& p, const std::string& v) -> checker_ret_t {
-    std::vector<std::string> vs = utils::split(s, '|');
-    bool is_in = false;
-    if (std::any_of(vs.begin(), vs.end(), [v](const std::string& vv) {
-      return v == vv;
-    })) {is_in = true;}
-
-    return std::make_tuple(is_in, utils::format_error(
-      p, v, "Not in " + utils::wrap(s, "[]")
-    ));
-  };
+  return is_short_param(p) || is_long_param(p);
 }
 
 /**
- * @ingroup Checkers
- * @brief lower checker factory
+ * @ingroup Utilities
+ * @brief trim_param
+ *
  * @code
- * auto lower10 = lower(10);
- * throw_if_false(lower10("--param", "5"));
+ * trim_param("--param") -> "param"
  * @endcode
- * @param n
- * @return checker_fn_t
+ * @param p a parameter to trim
+ * @return std::string
  */
-inline checker_fn_t lower(int n)
+inline std::string trim_param(const std::string& p)
 {
-  return [n](const std::string& p, const std::string& v) -> checker_ret_t {
-    throw_if_false(is_number(p, v));
-    int value = std::stoi(v);
-    return std::make_tuple(value < n, utils::format_error(p, v, v + ">=" + std::to_string(n)));
-  };
+  return ltrim(p, "-");
 }
 
 /**
- * @ingroup Checkers
- * @brief higher checker factory
- * @code
- * auto higher10 = higher(10);
- * throw_if_false(lower10("--param", "15"));
- * @endcode
- * @param n
- * @return checker_fn_t
+ * @ingroup Utilities
+ * @brief format_error
+ *
+ * @param p
+ * @param v
+ * @param m
+ * @return std::string
  */
-inline checker_fn_t higher(int n)
+inline std::string format_error(const std::string& p, const std::string& v, const std::string& m)
 {
-  return [n](const std::string& p, const std::string& v) -> checker_ret_t {
-    throw_if_false(is_number(p, v));
-    int value = std::stoi(v);
-    return std::make_tuple(value > n, utils::format_error(p, v, v + "<=" + std::to_string(n)));
-  };
+  std::stringstream ss;
+  ss << "[" << p << " " << v << "]" << " ~ " << m;
+  return ss.str();
 }
 
 /**
- * @ingroup Checkers
- * @brief check_magic checker factory
- * @code
- * auto is_gz = f::check_magic<2>("gz", {0x1F, 0x8B});
- * throw_if_false(is_gz("--param", "/path/to/file.gz"));
- * @endcode
- * @tparam SIZE number of magic bytes, std::array<uint8_t, SIZE>
- * @param name a name
- * @param flag an array of bytes
- * @return checker_fn_t
+ * @ingroup Utilities
+ * @brief  format_depend_errors
+ *
+ * @tparam T
+ * @param p
+ * @param d
+ * @param msg
+ * @return std::string
  */
-template<size_t SIZE>
-inline checker_fn_t check_magic(const std::string& name, std::array<uint8_t, SIZE> flag)
+template<typename T>
+inline std::string format_depend_errors(T p, T d, const std::string& msg)
 {
-  return [name, flag](const std::string& p, const std::string& v) -> checker_ret_t {
-    throw_if_false(is_file(p, v));
-
-    bool is_valid = false;
-
-    std::array<uint8_t, SIZE> buffer;
-    std::ifstream inf(v, std::ios::binary | std::ios::in);
-    if (inf.good())
-      inf.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
-
-    if (buffer == flag) is_valid = true;
-
-    return std::make_tuple(is_valid,
-                           utils::format_error(p, v, "Not a " + name + " file."));
-  };
+  std::stringstream ss;
+  ss << p->raw() << " " << p->value() << " depends on " << d->raw();
+  ss << " ~ " << "Check returns -> " << msg;
+  return ss.str();
 }
 
-} // end of namespace f (checker factories)
-
 /**
- * @ingroup Checkers
- * @brief fastx ext checker
+ * @ingroup Utilities
+ * @brief format_banned_errors
  *
+ * @tparam T
+ * @param p
+ * @param d
+ * @param msg
+ * @return std::string
  */
-inline checker_fn_t seems_fastx = f::ext("fa|fna|fasta|fastq|fq");
+template<typename T>
+inline std::string format_banned_errors(T p, T d, const std::string& msg)
+{
+  std::stringstream ss;
+  ss << p->raw() << " " << p->value() << " is banned with " << d->raw() << " " << d->value();
+  ss << " ~ " << "Check returns -> " << msg;
+  return ss.str();
+}
 
 /**
- * @ingroup Checkers
- * @brief fasta ext checker
+ * @ingroup Utilities
+ * @brief format_depend_errors
  *
+ * @param p param name
+ * @param pv param value
+ * @param d dependency name
+ * @param msg
+ * @return std::string
  */
-inline checker_fn_t seems_fasta = f::ext("fa|fna|fasta");
+inline std::string format_depend_errors(const std::string& p, const std::string& pv,
+                                        const std::string& d, const std::string& msg)
+{
+  std::stringstream ss;
+  ss << p << " " << pv << " depends on " << d;
+  ss << " ~ " << "Check returns -> " << msg;
+  return ss.str();
+}
 
 /**
- * @ingroup Checkers
- * @brief fastq ext checker
+ * @ingroup Utilities
+ * @brief format_banned_errors
  *
+ * @param p param name
+ * @param pv param value
+ * @param d banned param name
+ * @param dv banned param value
+ * @param msg
+ * @return std::string
  */
-inline checker_fn_t seems_fastq = f::ext("fastq|fq");
+inline std::string format_banned_errors(const std::string& p, const std::string& pv,
+                                        const std::string& d, const std::string& dv,
+                                        const std::string& msg)
+{
+  std::stringstream ss;
+  ss << p << " " << pv << " is banned with " << d << " " << dv;
+  ss << " ~ " << "Check returns -> " << msg;
+  return ss.str();
+}
 
-/**
- * @ingroup Checkers
- * @brief sam ext checker
- *
- */
-inline checker_fn_t seems_sam = f::ext("sam");
+class param_t;
+template<>
+inline std::string format_banned_errors(param_t, param_t, const std::string& msg);
 
 /**
- * @ingroup Checkers
- * @brief bam ext checker
+ * @ingroup Utilities
+ * @brief valid_string
  *
+ * @code
+ * auto validator = [](const char& c) -> bool {
+ *   if (c == 'A' || c == 'C' || c == 'T' || c == 'G')
+ *     return true;
+ *   return false;
+ * };
+ * valid_string("ACGTTTACGA", validator);
+ * @endcode
+ * @tparam std::function<bool(const char&)>
+ * @param s
+ * @param valid
+ * @return true if s is valid
+ * @return false if s is invalid
  */
-inline checker_fn_t seems_bam = f::ext("bam");
+template<typename Validator = std::function<bool(const char&)>>
+bool valid_string(const std::string& s, Validator valid)
+{
+  for (const char& c : s)
+    if (!valid(c))
+      return false;
+  return true;
+}
 
 /**
- * @ingroup Checkers
- * @brief cram ext checker
+ * @ingroup Utilities
+ * @brief parse_range_list
  *
- */
-inline checker_fn_t seems_cram = f::ext("cram");
-
-/**
- * @ingroup Checkers
- * @brief comp ext checker
+ * Parse a range list in one pass, without intermediate strings. Items are sep by ','
+ * and can be a value "N", a range "N-M" or a stepped range "N-M:S".
+ * Bounds are checked once per range (ranges are arithmetic). The output is sorted and
+ * deduplicated. A list expanding to more than max_size values is rejected.
  *
- */
-inline checker_fn_t seems_comp = f::ext("gz|bz2|lz4");
-
-/**
- * @ingroup Checkers
- * @brief gz ext checker
+ * @code
+ * std::vector<int> out;
+ * parse_range_list<int>("15-21:2,41,51-53", out) -> out = {15,17,19,21,41,51,52,53}
+ * @endcode
  *
+ * @tparam T An integral type
+ * @param s a range list
+ * @param out output vector, cleared before parsing
+ * @param lo lower bound
+ * @param hi upper bound
+ * @param max_size maximum number of values
+ * @return std::tuple<bool, std::string> false and an error message if s is invalid
  */
-inline checker_fn_t seems_gz = f::ext("gz");
+template<typename T,
+         typename = typename std::enable_if_t<std::is_integral_v<T>, void>>
+std::tuple<bool, std::string> parse_range_list(std::string_view s,
+                                               std::vector<T>& out,
+                                               T lo = std::numeric_limits<T>::min(),
+                                               T hi = std::numeric_limits<T>::max(),
+                                               size_t max_size = size_t(1) << 20)
+{
+  out.clear();
+  const char* it = s.data();
+  const char* end = s.data() + s.size();
+  bool sorted = true;
+
+  auto error = [&](const std::string& msg) {
+    out.clear();
+    return std::make_tuple(false, msg);
+  };
 
-/**
- * @ingroup Checkers
- * @brief fastx
- *
- */
-inline checker_fn_t seems_lz4 = f::ext("lz4");
+  if (it == end)
+    return error("Empty range list.");
+
+  while (it <= end)
+  {
+    const char* item = it;
+    T first, last, step = 1;
+    auto [p, ec] = std::from_chars(it, end, first);
+    if (ec != std::errc())
+      return error("Invalid range at position " + std::to_string(item - s.data()) + ".");
+    last = first;
+    if (p != end && *p == '-')
+    {
+      auto [p2, ec2] = std::from_chars(p + 1, end, last);
+      if (ec2 != std::errc())
+        return error("Invalid range at position " + std::to_string(item - s.data()) + ".");
+      p = p2;
+      if (p != end && *p == ':')
+      {
+        auto [p3, ec3] = std::from_chars(p + 1, end, step);
+        if (ec3 != std::errc() || step <= 0)
+          return error("Invalid step at position " + std::to_string(item - s.data()) + ".");
+        p = p3;
+      }
+    }
+    if (p != end && *p != ',')
+      return error("Unexpected '" + std::string(1, *p) + "' at position "
+                   + std::to_string(p - s.data()) + ".");
+    if (last < first)
+      return error(std::string(item, p) + " is a decreasing range.");
+    if (first < lo || last > hi)
+      return error(std::string(item, p) + " not in range ["
+                   + std::to_string(lo) + "," + std::to_string(hi) + "].");
+
+    // span arithmetic in the unsigned type, last - first may not fit in T
+    using U = std::make_unsigned_t<T>;
+    U n = static_cast<U>(static_cast<U>(last) - static_cast<U>(first)) / static_cast<U>(step);
+    if (n >= max_size || out.size() > max_size - 1 - n)
+      return error("Range list " + std::string(s) + " expands to more than "
+                   + std::to_string(max_size) + " values.");
+
+    if (!out.empty() && first <= out.back())
+      sorted = false;
+    out.reserve(out.size() + static_cast<size_t>(n) + 1);
+    U v = static_cast<U>(first);
+    for (U i = 0; i <= n; ++i, v += static_cast<U>(step))
+      out.push_back(static_cast<T>(v));
+    it = p + 1;
+  }
+
+  if (!sorted)
+  {
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+  }
+  return std::make_tuple(true, "");
+}
 
 /**
- * @ingroup Checkers
- * @brief gz checker
+ * @ingroup Utilities
+ * @brief MappedFile
  *
+ * Read-only file mapping (mmap on posix systems, a plain read otherwise).
  */
-inline auto is_gz = f::check_magic<2>("gz", {0x1F, 0x8B});
+class MappedFile
+{
+public:
+  MappedFile(const std::string& path)
+  {
+#ifdef BCLI_POSIX
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (::fstat(fd, &st) == 0)
+    {
+      m_size = static_cast<size_t>(st.st_size);
+      m_good = true;
+      if (m_size > 0)
+      {
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+          m_good = false;
+        else
+        {
+          m_addr = addr;
+          ::madvise(addr, m_size, MADV_SEQUENTIAL);
+        }
+      }
+    }
+    ::close(fd);
+#else
+    std::ifstream inf(path, std::ios::binary | std::ios::in);
+    if (inf.good())
+    {
+      m_buffer.assign(std::istreambuf_iterator<char>(inf), std::istreambuf_iterator<char>());
+      m_size = m_buffer.size();
+      m_good = true;
+    }
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifdef BCLI_POSIX
+    if (m_addr)
+      ::munmap(m_addr, m_size);
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool good() const { return m_good; }
+  size_t size() const { return m_size; }
+
+  const char* data() const
+  {
+#ifdef BCLI_POSIX
+    return static_cast<const char*>(m_addr);
+#else
+    return m_buffer.data();
+#endif
+  }
+
+PRIVATE:
+  size_t m_size {0};
+  bool   m_good {false};
+#ifdef BCLI_POSIX
+  void*  m_addr {nullptr};
+#else
+  std::string m_buffer;
+#endif
+};
 
 /**
- * @ingroup Checkers
- * @brief lz4_frame checker
+ * @ingroup Utilities
+ * @brief list_dir
+ *
+ * Call fn(name, is_dir, inode) for each entry of a directory, except "." and "..".
+ * Uses getdents64 on linux, reading entries in large batches without opendir buffers;
+ * std::filesystem otherwise. Symlinks and entries of unknown type are resolved with
+ * stat.
  *
+ * @param dir
+ * @param fn void(std::string_view, bool, uint64_t)
+ * @return false if dir can't be opened
  */
-inline auto is_lz4_frame = f::check_magic<4>("lz4frame", {0x04, 0x22, 0x4D, 0x18});
+template<typename Fn>
+bool list_dir(const std::string& dir, Fn&& fn)
+{
+#ifdef BCLI_GETDENTS
+  struct dirent64_t
+  {
+    uint64_t       d_ino;
+    int64_t        d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[1];
+  };
+
+  int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  // closes fd if fn throws
+  struct Closer
+  {
+    int fd;
+    ~Closer() { ::close(fd); }
+  } closer {fd};
+  alignas(dirent64_t) char buffer[1 << 15];
+  std::string path;
+  for (long n; (n = ::syscall(SYS_getdents64, fd, buffer, sizeof(buffer))) > 0;)
+  {
+    for (long off = 0; off < n;)
+    {
+      auto* d = reinterpret_cast<dirent64_t*>(buffer + off);
+      off += d->d_reclen;
+      std::string_view name(d->d_name);
+      if (name == "." || name == "..")
+        continue;
+      bool is_dir = d->d_type == DT_DIR;
+      if (d->d_type == DT_UNKNOWN || d->d_type == DT_LNK)
+      {
+        struct stat st;
+        path.assign(dir).append("/").append(name);
+        if (::stat(path.c_str(), &st) != 0)
+          continue;
+        // don't follow symlinks to directories, avoids cycles
+        is_dir = S_ISDIR(st.st_mode) && d->d_type != DT_LNK;
+        if (S_ISDIR(st.st_mode) && d->d_type == DT_LNK)
+          continue;
+      }
+      fn(name, is_dir, static_cast<uint64_t>(d->d_ino));
+    }
+  }
+  return true;
+#else
+  std::error_code ec;
+  fs::directory_iterator it(dir, ec);
+  if (ec)
+    return false;
+  for (; it != fs::directory_iterator(); it.increment(ec))
+  {
+    if (ec)
+      break;
+    bool is_dir = it->is_directory(ec) && !it->is_symlink(ec);
+    if (!is_dir && it->is_directory(ec))
+      continue;
+    std::string name = it->path().filename().string();
+    fn(std::string_view(name), is_dir, uint64_t{0});
+  }
+  return true;
+#endif
+}
+
+/**
+ * @ingroup Utilities
+ * @brief walk_dir
+ *
+ * Call fn(path, inode) for each file under root, on nb_threads threads. Directories
+ * are shared through a queue, so idle threads pick up the subdirectories found by busy
+ * ones. fn must be thread-safe. If fn throws, the walk stops and the first exception is
+ * rethrown once all threads joined.
+ *
+ * @param root
+ * @param recursive
+ * @param nb_threads number of threads, 0 -> std::thread::hardware_concurrency()
+ * @param fn void(const std::string&, uint64_t)
+ */
+template<typename Fn>
+void walk_dir(const std::string& root, bool recursive, size_t nb_threads, Fn&& fn)
+{
+  if (nb_threads == 0)
+    nb_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  if (!recursive)
+    nb_threads = 1;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::string> dirs {root};
+  size_t active = 0;
+  FirstError error;
+
+  auto worker = [&]() {
+    std::string path;
+    while (true)
+    {
+      std::string dir;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return !dirs.empty() || active == 0; });
+        if (error.failed())
+          dirs.clear();
+        if (dirs.empty())
+          return;
+        dir = std::move(dirs.back());
+        dirs.pop_back();
+        active++;
+      }
+      std::vector<std::string> found;
+      error.run([&]() {
+        list_dir(dir, [&](std::string_view name, bool is_dir, uint64_t ino) {
+          path.assign(dir);
+          if (path.back() != '/')
+            path += '/';
+          path.append(name);
+          if (!is_dir)
+            fn(path, ino);
+          else if (recursive)
+            found.push_back(path);
+        });
+      });
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        dirs.insert(dirs.end(), std::make_move_iterator(found.begin()),
+                    std::make_move_iterator(found.end()));
+        active--;
+      }
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  spawn(threads, nb_threads - 1, worker);
+  worker();
+  for (auto& t : threads)
+    t.join();
+  error.rethrow();
+}
+
+/**
+ * @ingroup Utilities
+ * @brief is_glob
+ *
+ * @param s
+ * @return true if s contains a glob char (*?[{)
+ */
+inline bool is_glob(std::string_view s)
+{
+  return s.find_first_of("*?[{") != std::string_view::npos;
+}
+
+/**
+ * @ingroup Utilities
+ * @brief FileId
+ *
+ * Identity of a file, (st_dev, st_ino) on posix systems, the canonical path otherwise:
+ * hardlinks (posix only) and symlinks to a file have the same id.
+ */
+struct FileId
+{
+  uint64_t    dev {0};
+  uint64_t    ino {0};
+  std::string path {};
+
+  bool operator==(const FileId& other) const
+  {
+    return dev == other.dev && ino == other.ino && path == other.path;
+  }
+
+  struct hash
+  {
+    size_t operator()(const FileId& id) const
+    {
+      return std::hash<uint64_t>()(id.ino * 0x9E3779B97F4A7C15ULL ^ id.dev) ^
+             std::hash<std::string>()(id.path);
+    }
+  };
+};
+
+/**
+ * @ingroup Utilities
+ * @brief file_id
+ *
+ * @param path
+ * @param id
+ * @return false if path doesn't exist
+ */
+inline bool file_id(const std::string& path, FileId& id)
+{
+#ifdef BCLI_POSIX
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0)
+    return false;
+  id = {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino), {}};
+  return true;
+#else
+  std::error_code ec;
+  fs::path canonical = fs::canonical(path, ec);
+  if (ec)
+    return false;
+  id = {0, 0, canonical.string()};
+  return true;
+#endif
+}
+
+/**
+ * @ingroup Utilities
+ * @brief expand a glob or a directory into the files it matches, sorted
+ *
+ * A directory gives its files. In a glob, '*' also matches '/', and a "**" path
+ * component matches any number of directories (recursive walk). Other values are
+ * returned as is.
+ *
+ * @code
+ * expand_path("runs", 8, keep);                  // files in runs
+ * expand_path("runs/sample_*.fq.gz", 8, keep);   // sample fastq files in runs
+ * @endcode
+ *
+ * @param arg
+ * @param nb_threads number of threads of the directory walker
+ * @param keep bool(const std::string&), a filter on the files
+ * @return std::vector<std::string>, {arg} if nothing matches
+ */
+template<typename Keep>
+std::vector<std::string> expand_path(const std::string& arg, size_t nb_threads, Keep&& keep)
+{
+  std::string dir = arg;
+  std::string pattern = "*";
+  bool recursive = false;
+  if (is_glob(arg))
+  {
+    size_t slash = arg.rfind('/', arg.find_first_of("*?[{"));
+    dir = slash == std::string::npos ? "." : arg.substr(0, slash == 0 ? 1 : slash);
+    pattern = arg.substr(slash == std::string::npos ? 0 : slash + 1);
+    recursive = pattern.find('/') != std::string::npos || pattern == "**";
+    for (size_t p; (p = pattern.find("**/")) != std::string::npos;)
+      pattern.replace(p, 3, "{,*/}");
+  }
+  else if (std::error_code ec; !fs::is_directory(arg, ec))
+    return {arg};
+
+  Dfa dfa = Dfa::from_glob(pattern);
+  std::string prefix = dir == "." && !utils::startswith(arg, "./") ? "" : dir;
+  size_t skip = dir.size() + (dir.back() == '/' ? 0 : 1);
+
+  std::mutex mutex;
+  std::vector<std::string> files;
+  walk_dir(dir, recursive, nb_threads, [&](const std::string& path, uint64_t) {
+    std::string_view rel = std::string_view(path).substr(skip);
+    if (!dfa.match(rel))
+      return;
+    std::string file = prefix.empty() ? std::string(rel) : path;
+    if (!keep(file))
+      return;
+    std::lock_guard<std::mutex> lock(mutex);
+    files.push_back(std::move(file));
+  });
+  if (files.empty())
+    return {arg};
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+/**
+ * @ingroup Utilities
+ * @brief load_numbers
+ *
+ * Load numbers from a text file. Numbers are sep by any of " \t\r\n,;" and parsed
+ * with std::from_chars, directly from the mapped file.
+ *
+ * @tparam T An arithmetic type
+ * @param path
+ * @param out output vector, cleared before loading
+ * @return std::tuple<bool, std::string> false and an error message on failure
+ */
+template<typename T,
+         typename = typename std::enable_if_t<std::is_arithmetic_v<T>, void>>
+std::tuple<bool, std::string> load_numbers(const std::string& path, std::vector<T>& out)
+{
+  out.clear();
+  MappedFile file(path);
+  if (!file.good())
+    return std::make_tuple(false, "Unable to read " + path + ".");
+
+  const char* it = file.data();
+  const char* end = it + file.size();
+
+  // one value per line is the common case, counting lines is cheap (memchr)
+  out.reserve(static_cast<size_t>(std::count(it, end, '\n')) + 1);
+
+  std::array<bool, 256> is_sep {};
+  for (unsigned char c : std::string_view(" \t\r\n,;"))
+    is_sep[c] = true;
+
+  while (it != end)
+  {
+    while (it != end && is_sep[static_cast<unsigned char>(*it)])
+      ++it;
+    if (it == end)
+      break;
+    T value;
+    auto [ptr, ec] = std::from_chars(it, end, value);
+    if (ec != std::errc() || (ptr != end && !is_sep[static_cast<unsigned char>(*ptr)]))
+    {
+      const char* tok_end = std::find_if(it, end, [&is_sep](char c) {
+        return is_sep[static_cast<unsigned char>(c)];
+      });
+      std::string token(it, tok_end);
+      out.clear();
+      return std::make_tuple(false, "Invalid value \"" + token + "\" at offset "
+                             + std::to_string(it - file.data()) + ".");
+    }
+    out.push_back(value);
+    it = ptr;
+  }
+  return std::make_tuple(true, "");
+}
+
+/**
+ * @ingroup Utilities
+ * @brief load_binary_numbers
+ *
+ * Load numbers from a raw binary file (native endianness, no header).
+ *
+ * @tparam T An arithmetic type
+ * @param path
+ * @param out output vector, cleared before loading
+ * @return std::tuple<bool, std::string> false and an error message on failure
+ */
+template<typename T,
+         typename = typename std::enable_if_t<std::is_arithmetic_v<T>, void>>
+std::tuple<bool, std::string> load_binary_numbers(const std::string& path, std::vector<T>& out)
+{
+  out.clear();
+  MappedFile file(path);
+  if (!file.good())
+    return std::make_tuple(false, "Unable to read " + path + ".");
+  if (file.size() % sizeof(T) != 0)
+    return std::make_tuple(false, "File size is not a multiple of " + std::to_string(sizeof(T)) + ".");
+  out.resize(file.size() / sizeof(T));
+  if (file.size() > 0)
+    std::memcpy(out.data(), file.data(), file.size());
+  return std::make_tuple(true, "");
+}
+
+/**
+ * @ingroup Utilities
+ * @brief sp
+ *
+ * @param n
+ * @return std::string
+ */
+inline std::string sp(int n)
+{
+  return std::string(n, ' ');
+}
+
+/**
+ * @ingroup Utilities
+ * @brief exit_bcli
+ *
+ * @param e
+ */
+inline void exit_bcli(const ex::BCliError& e)
+{
+  if (!e.get_name().empty())
+    std::cerr << wrap(e.get_name(), "[]") << " -> " << e.get_msg() << std::endl;
+}
+
+} // end of namespace utils
+
+/**
+ * @defgroup Checkers
+ * @brief About bcli checkers.
+ *
+ * Checkers are functions used to parameter value validation.
+ * A checker take two parameters:
+ *  - an id, usually a parameter (ex: "--param")
+ *  - a value to check
+ *
+ * And returns a std::tuple<bool, std::string>
+ *  - 0: true if check success, false otherwise
+ *  - 1: An error message
+ *
+ * Two namespaces:
+ *  - check -> contains checkers
+ *  - check::f -> contains factories
+ *
+ */
+
+/**
+ * @namespace check
+ * @ingroup Checkers
+ * @brief bcli check namespace
+ *
+ */
+namespace check {
+
+/**
+ * @typedef checker_ret_t
+ * @ingroup Checkers
+ * @brief checkers return type
+ *
+ */
+using checker_ret_t = std::tuple<bool, std::string>;
+
+/**
+ * @typedef checker_fn_t
+ * @ingroup Checkers
+ * @brief checkers function signature
+ *
+ */
+using checker_fn_t = std::function<checker_ret_t(const std::string&, const std::string&)>;
+
+/**
+ * @enum Cost
+ * @ingroup Checkers
+ * @brief checker cost classes, cheaper checkers are evaluated first
+ *
+ */
+enum class Cost
+{
+  Pure,   /*!< No I/O, only the value. */
+  Stat,   /*!< Reads file metadata. */
+  Header, /*!< Reads the first bytes of a file. */
+  Full    /*!< Reads a whole file, or unknown cost. */
+};
+
+using checker_ptr_t = checker_ret_t(*)(const std::string&, const std::string&);
+
+inline Cost cost_of(checker_ptr_t fn);
+
+using steady_t = std::chrono::steady_clock;
+
+/**
+ * @ingroup Checkers
+ * @brief deadline of the current parse on this thread, see Parser::set_deadline
+ *
+ * @return std::optional<steady_t::time_point>&
+ */
+inline std::optional<steady_t::time_point>& parse_deadline()
+{
+  thread_local std::optional<steady_t::time_point> deadline;
+  return deadline;
+}
+
+/**
+ * @ingroup Checkers
+ * @brief Deadline
+ *
+ * Set the parse deadline of the current thread for its lifetime, if none is set.
+ */
+class Deadline
+{
+public:
+  explicit Deadline(std::chrono::milliseconds timeout)
+  {
+    if (timeout.count() > 0 && !parse_deadline())
+    {
+      parse_deadline() = steady_t::now() + timeout;
+      m_owner = true;
+    }
+  }
+
+  // install a deadline captured on another thread, for worker threads of a parse
+  explicit Deadline(std::optional<steady_t::time_point> until)
+  {
+    if (until && !parse_deadline())
+    {
+      parse_deadline() = until;
+      m_owner = true;
+    }
+  }
+
+  ~Deadline()
+  {
+    if (m_owner)
+      parse_deadline().reset();
+  }
+
+  Deadline(const Deadline&) = delete;
+  Deadline& operator=(const Deadline&) = delete;
+
+PRIVATE:
+  bool m_owner {false};
+};
+
+/**
+ * @ingroup Checkers
+ * @brief number of run_until workers still running, stalled ones included
+ *
+ * @return std::atomic<size_t>&
+ */
+inline std::atomic<size_t>& live_workers()
+{
+  static std::atomic<size_t> nb {0};
+  return nb;
+}
+
+/**
+ * @ingroup Checkers
+ * @brief run fn on a worker thread, gives up if it doesn't return before until
+ *
+ * A blocked worker (ex: stale network mount) can't be interrupted, it is detached and
+ * its result is dropped. It only owns a copy of fn, a worker still blocked at exit is
+ * left to the OS. No worker is started once until is passed, or while
+ * 4 * hardware_concurrency workers are still running, so stalled paths don't pile up
+ * threads.
+ *
+ * @tparam Fn R(), copied to the worker
+ * @param fn
+ * @param until
+ * @return std::optional<R>, empty on timeout
+ */
+template<typename Fn>
+std::optional<std::invoke_result_t<Fn>> run_until(Fn fn, steady_t::time_point until)
+{
+  using R = std::invoke_result_t<Fn>;
+  static const size_t max_workers = 4 * std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  if (steady_t::now() >= until || live_workers() >= max_workers)
+    return std::nullopt;
+
+  auto task = std::make_shared<std::packaged_task<R()>>(std::move(fn));
+  std::future<R> result = task->get_future();
+  live_workers()++;
+#if BCLI_EXCEPTIONS
+  try
+  {
+#endif
+    std::thread([task]() {
+      (*task)();
+      live_workers()--;
+    }).detach();
+#if BCLI_EXCEPTIONS
+  }
+  catch (const std::system_error&)
+  {
+    live_workers()--;
+    return std::nullopt;
+  }
+#endif
+  if (result.wait_until(until) == std::future_status::timeout)
+    return std::nullopt;
+  return result.get();
+}
+
+/**
+ * @ingroup Checkers
+ * @brief run a checker on a worker thread, fails if it doesn't return before until
+ *
+ * @see run_until(Fn, steady_t::time_point)
+ * @param fn
+ * @param p
+ * @param v
+ * @param until
+ * @return checker_ret_t
+ */
+inline checker_ret_t run_until(const checker_fn_t& fn,
+                               const std::string& p,
+                               const std::string& v,
+                               steady_t::time_point until)
+{
+  if (auto rc = run_until([fn, p, v]() { return fn(p, v); }, until))
+    return std::move(*rc);
+  return std::make_tuple(false, utils::format_error(p, v, "Check timed out, stale mount?"));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief Checker
+ *
+ * A checker with a declared cost. Built-in checkers and factories declare their cost,
+ * others are considered as Cost::Full.
+ *
+ * @code
+ * auto is_index = check::Checker(my_index_checker, check::Cost::Header);
+ * @endcode
+ */
+class Checker
+{
+public:
+  Checker() = default;
+
+  Checker(checker_fn_t fn, Cost cost = Cost::Full)
+    : m_fn(std::move(fn)), m_cost(cost) {}
+
+  Checker(checker_ptr_t fn)
+    : m_fn(fn), m_cost(cost_of(fn)) {}
+
+  template<typename F,
+           typename = std::enable_if_t<
+             std::is_invocable_r_v<checker_ret_t, F, const std::string&, const std::string&>
+             && !std::is_same_v<std::decay_t<F>, Checker>
+             && !std::is_same_v<std::decay_t<F>, checker_fn_t>
+             && !std::is_same_v<std::decay_t<F>, checker_ptr_t>>>
+  Checker(F fn, Cost cost = Cost::Full)
+    : m_fn(std::move(fn)), m_cost(cost) {}
+
+  /**
+   * @brief run the checker
+   *
+   * Runs on a worker thread if the checker has a timeout (see f::timeout), or if it
+   * does I/O while a parse deadline is set (see Parser::set_deadline).
+   */
+  checker_ret_t operator()(const std::string& p, const std::string& v) const
+  {
+    std::optional<steady_t::time_point> until;
+    if (m_timeout.count() > 0)
+      until = steady_t::now() + m_timeout;
+    if (m_cost != Cost::Pure && parse_deadline() && (!until || *parse_deadline() < *until))
+      until = parse_deadline();
+    if (!until)
+      return m_fn(p, v);
+    return run_until(m_fn, p, v, *until);
+  }
+
+  Cost cost() const
+  {
+    return m_cost;
+  }
+
+  /**
+   * @brief copy of the checker with a timeout
+   *
+   * @param timeout
+   * @return Checker
+   */
+  Checker with_timeout(std::chrono::milliseconds timeout) const
+  {
+    Checker c = *this;
+    c.m_timeout = timeout;
+    return c;
+  }
+
+  explicit operator bool() const
+  {
+    return static_cast<bool>(m_fn);
+  }
+
+PRIVATE:
+  checker_fn_t m_fn {nullptr};
+  Cost         m_cost {Cost::Full};
+  std::chrono::milliseconds m_timeout {0};
+};
+
+/**
+ * @ingroup Checkers
+ * @brief sort checkers by cost, stable
+ *
+ * @param checkers
+ */
+inline void sort_by_cost(std::vector<Checker>& checkers)
+{
+  std::stable_sort(checkers.begin(), checkers.end(), [](const Checker& a, const Checker& b) {
+    return a.cost() < b.cost();
+  });
+}
+
+/**
+ * @ingroup Checkers
+ * @brief eval_all, true if all checkers pass, stops at the first failure
+ *
+ * @param checkers
+ * @param p
+ * @param v
+ * @return checker_ret_t
+ */
+inline checker_ret_t eval_all(const std::vector<Checker>& checkers,
+                              const std::string& p, const std::string& v)
+{
+  for (auto& c : checkers)
+    if (auto rc = c(p, v); !std::get<0>(rc))
+      return rc;
+  return std::make_tuple(true, "");
+}
+
+/**
+ * @ingroup Checkers
+ * @brief eval_any, true if at least one checker passes, stops at the first success
+ *
+ * @param checkers
+ * @param p
+ * @param v
+ * @return checker_ret_t
+ */
+inline checker_ret_t eval_any(const std::vector<Checker>& checkers,
+                              const std::string& p, const std::string& v)
+{
+  std::vector<std::string> msgs;
+  for (auto& c : checkers)
+  {
+    auto [res, msg] = c(p, v);
+    if (res)
+      return std::make_tuple(true, "");
+    msgs.push_back(msg);
+  }
+  return std::make_tuple(checkers.empty(), utils::join(msgs, " or "));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief eval_one, true if exactly one checker passes, stops at the second success
+ *
+ * @param checkers
+ * @param p
+ * @param v
+ * @return checker_ret_t
+ */
+inline checker_ret_t eval_one(const std::vector<Checker>& checkers,
+                              const std::string& p, const std::string& v)
+{
+  std::vector<std::string> msgs;
+  size_t n = 0;
+  for (auto& c : checkers)
+  {
+    auto [res, msg] = c(p, v);
+    if (res && ++n > 1)
+      return std::make_tuple(false, utils::format_error(p, v, "Satisfies several exclusive checks."));
+    if (!res)
+      msgs.push_back(msg);
+  }
+  return std::make_tuple(n == 1, utils::join(msgs, " or "));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief eval_none, true if no checker passes, stops at the first success
+ *
+ * @param checkers
+ * @param p
+ * @param v
+ * @return checker_ret_t
+ */
+inline checker_ret_t eval_none(const std::vector<Checker>& checkers,
+                               const std::string& p, const std::string& v)
+{
+  for (auto& c : checkers)
+    if (std::get<0>(c(p, v)))
+      return std::make_tuple(false, utils::format_error(p, v, "Forbidden value."));
+  return std::make_tuple(true, "");
+}
+
+
+/**
+ * @ingroup Checkers
+ * @brief throw ex::CheckFailedError if checker returns false
+ *
+ * ex: throw_if_false(check::is_number("--integer", "10"));
+ */
+inline void throw_if_false(const checker_ret_t& rc)
+{
+  if (!std::get<0>(rc))
+    BCLI_THROW(ex::CheckFailedError(std::get<1>(rc)));
+}
+
+// Shortcut to define a new checker
+/**
+ * @ingroup Checkers
+ * @def DEFINE_CHECKER
+ * @brief define a new checker
+ */
+#define DEFINE_CHECKER(name, s1, s2)                                        \
+  inline checker_ret_t name(const std::string& s1, const std::string& s2)   \
+
+
+DEFINE_CHECKER(always_true, p, v)
+{
+  unused(p);
+  unused(v);
+  return std::make_tuple(true, "A true checker.");
+}
+
+/**
+ * @ingroup Checkers
+ * @brief is_file checker
+ *
+ * Return true if v corresponds to a file.
+ *
+ * ex: check::is_file("--param", "/path/to/file.txt");
+ *
+ * @param p parameter as string (ex: "--param")
+ * @param v parameter value
+ *
+ * @return std::tuple<bool, std::string>
+ */
+DEFINE_CHECKER(is_file, p, v)
+{
+  bool exists = fs::exists(v);
+  return std::make_tuple(exists, utils::format_error(p, v, "File doesn't exist!"));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief is_dir checker
+ *
+ * Return true if v corresponds to a directory.
+ *
+ * ex: check::is_dir("--param", "/path/to/dir");
+ *
+ * @param p parameter as string (ex: "--param")
+ * @param v parameter value
+ *
+ * @return std::tuple<bool, std::string>
+ */
+DEFINE_CHECKER(is_dir, p, v)
+{
+  bool exists = fs::is_directory(v);
+  return std::make_tuple(exists, utils::format_error(p, v, "Directory doesn't exist!"));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief is_number checker
+ *
+ * Return true if v corresponds to a number.
+ *
+ * ex: check::is_number("--param", "10");
+ *
+ * @param p parameter as string (ex: "--file")
+ * @param v parameter value
+ *
+ * @return std::tuple<bool, std::string>
+ */
+DEFINE_CHECKER(is_number, p, v)
+{
+  bool is = true;
+  bool neg = false;
+  for (const char& c : v)
+  {
+    if (!neg && c == '-')
+    {
+      neg = true;
+      continue;
+    }
+    if (!std::isdigit(c) && c != '.')
+    {
+      is = false;
+      break;
+    }
+  }
+  if (v.empty()) is = false;
+  return std::make_tuple(is, utils::format_error(p, v, "Not a number!"));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief is_dna checker
+ *
+ * Return true if v corresponds to a dna string.
+ *
+ * ex: check::is_dna("--param", "ACGACGA");
+ *
+ * @param p parameter as string (ex: "--param")
+ * @param v parameter value
+ *
+ * @return std::tuple<bool, std::string>
+ */
+DEFINE_CHECKER(is_dna, p, v)
+{
+  auto valid_nt = [](const char& c) -> bool {
+    switch (c)
+    {
+      case 'A': return true;
+      case 'C': return true;
+      case 'T': return true;
+      case 'G': return true;
+      default: return false;
+    }
+  };
+  return std::make_tuple(utils::valid_string(v, valid_nt),
+                         utils::format_error(p, v, "Not a valid dna string."));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief is_number checker
+ *
+ * Return true if v corresponds to a rna string.
+ *
+ * ex: check::is_rna("--param", "10");
+ *
+ * @param p parameter as string (ex: "--param")
+ * @param v parameter value
+ *
+ * @return std::tuple<bool, std::string>
+ */
+DEFINE_CHECKER(is_rna, p, v)
+{
+  auto valid_nt = [](const char& c) -> bool {
+    switch (c)
+    {
+      case 'A': return true;
+      case 'C': return true;
+      case 'U': return true;
+      case 'G': return true;
+      default: return false;
+    }
+  };
+  return std::make_tuple(utils::valid_string(v, valid_nt),
+                         utils::format_error(p, v, "Not a valid rna string."));
+}
+
+/**
+ * @ingroup Checkers
+ * @brief cost of a checker function
+ *
+ * @param fn
+ * @return Cost, Cost::Full if fn is not a built-in checker
+ */
+inline Cost cost_of(checker_ptr_t fn)
+{
+  if (fn == &always_true || fn == &is_number || fn == &is_dna || fn == &is_rna)
+    return Cost::Pure;
+  if (fn == &is_file || fn == &is_dir)
+    return Cost::Stat;
+  return Cost::Full;
+}
+
+/**
+ * @namespace f
+ * @ingroup Checkers
+ * @brief bcli checker factories namespace
+ *
+ * Checker factories are function that return check::Checker, a check::checker_fn_t
+ * with a cost. This allows configurable checkers.
+ *
+ */
+namespace f {
+
+/**
+ * @ingroup Checkers
+ * @brief extension checker factory
+ *
+ * @code
+ * auto seems_fasta = check::f::ext("fa|fna");
+ * throw_if_false(seems_fasta("--param", "/path/to/file.fasta"));
+ * @endcode
+ * @param ext A set of extensions as string, sep by '|'.
+ * @return Checker
+ */
+inline Checker ext(const std::string& ext)
+{
+  return Checker([ext](const std::string& p, const std::string&v) -> checker_ret_t {
+    std::vector<std::string> exts = utils::split(ext, '|');
+    auto error_msg = std::bind(&utils::format_error, p, v, std::placeholders::_1);
+    if (!fs::path(v).has_extension())
+      return std::make_tuple(false, error_msg("No extension."));
+    else
+    {
+      if (std::any_of(exts.begin(), exts.end(), std::bind(&utils::endswith, v, std::placeholders::_1)))
+      {
+        return std::make_tuple<bool, std::string>(true, {});
+      }
+      else
+      {
+        std::string extp = fs::path(v).extension();
+        return std::make_tuple(false, error_msg(extp + "!=" + ext));
+      }
+    }
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief range checker factory
+ * @code
+ * auto in_10_100 = check::range(10, 100);
+ * throw_if_false(in_10_100("--param", "42"));
+ * @endcode
+ * @tparam T An arithmetic type
+ * @tparam std::enable_if_t<std::is_arithmetic_v<T>, void>
+ * @param start lower bound
+ * @param end upper bound
+ * @return Checker
+ */
+template<typename T,
+         typename = typename std::enable_if_t<std::is_arithmetic_v<T>, void>>
+inline Checker range(T start, T end)
+{
+  return Checker([start, end](const std::string& p, const std::string& v) -> checker_ret_t {
+    if (auto rc = is_number(p, v); !std::get<0>(rc))
+      return rc;
+    // a value that doesn't fit in T is out of range, no exception
+    T value;
+    bool in_range = utils::try_from_string(v, value) && (value >= start) && (value <= end);
+    return std::make_tuple(in_range, utils::format_error(
+      p, v, "Not in range [" + std::to_string(start) + "," + std::to_string(end) +"]."));
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief in checker factory
+ * @code
+ * auto is_valid_cmd = in("cmd2|cmd3");
+ * throw_if_false(is_valid_cmd("--param", "cmd3"));
+ * @endcode
+ * @param s A set of strings as one string, sep by '|'.
+ * @return Checker
+ */
+inline Checker in(const std::string& s)
+{
+  return Checker([s](const std::string& p, const std::string& v) -> checker_ret_t {
+    std::vector<std::string> vs = utils::split(s, '|');
+    bool is_in = false;
+    if (std::any_of(vs.begin(), vs.end(), [v](const std::string& vv) {
+      return v == vv;
+    })) {is_in = true;}
+
+    return std::make_tuple(is_in, utils::format_error(
+      p, v, "Not in " + utils::wrap(s, "[]")
+    ));
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief lower checker factory
+ * @code
+ * auto lower10 = lower(10);
+ * throw_if_false(lower10("--param", "5"));
+ * @endcode
+ * @param n
+ * @return Checker
+ */
+inline Checker lower(int n)
+{
+  return Checker([n](const std::string& p, const std::string& v) -> checker_ret_t {
+    if (auto rc = is_number(p, v); !std::get<0>(rc))
+      return rc;
+    double value;
+    if (!utils::try_from_string(v, value))
+      return std::make_tuple(false, utils::format_error(p, v, "Not a number!"));
+    return std::make_tuple(value < n, utils::format_error(p, v, v + ">=" + std::to_string(n)));
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief higher checker factory
+ * @code
+ * auto higher10 = higher(10);
+ * throw_if_false(lower10("--param", "15"));
+ * @endcode
+ * @param n
+ * @return Checker
+ */
+inline Checker higher(int n)
+{
+  return Checker([n](const std::string& p, const std::string& v) -> checker_ret_t {
+    if (auto rc = is_number(p, v); !std::get<0>(rc))
+      return rc;
+    double value;
+    if (!utils::try_from_string(v, value))
+      return std::make_tuple(false, utils::format_error(p, v, "Not a number!"));
+    return std::make_tuple(value > n, utils::format_error(p, v, v + "<=" + std::to_string(n)));
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief check_magic checker factory
+ * @code
+ * auto is_gz = f::check_magic<2>("gz", {0x1F, 0x8B});
+ * throw_if_false(is_gz("--param", "/path/to/file.gz"));
+ * @endcode
+ * @tparam SIZE number of magic bytes, std::array<uint8_t, SIZE>
+ * @param name a name
+ * @param flag an array of bytes
+ * @return Checker
+ */
+template<size_t SIZE>
+inline Checker check_magic(const std::string& name, std::array<uint8_t, SIZE> flag)
+{
+  return Checker([name, flag](const std::string& p, const std::string& v) -> checker_ret_t {
+    if (auto rc = is_file(p, v); !std::get<0>(rc))
+      return rc;
+
+    bool is_valid = false;
+
+    std::array<uint8_t, SIZE> buffer;
+    std::ifstream inf(v, std::ios::binary | std::ios::in);
+    if (inf.good())
+      inf.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+
+    if (buffer == flag) is_valid = true;
+
+    return std::make_tuple(is_valid,
+                           utils::format_error(p, v, "Not a " + name + " file."));
+  }, Cost::Header);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief range_list checker factory
+ * @code
+ * auto kmer_sizes = check::f::range_list(15, 63);
+ * throw_if_false(kmer_sizes("--kmer-sizes", "15-31:2,41,51-63"));
+ * @endcode
+ * @see utils::parse_range_list
+ * @tparam T An integral type
+ * @param lo lower bound
+ * @param hi upper bound
+ * @return Checker
+ */
+template<typename T,
+         typename = typename std::enable_if_t<std::is_integral_v<T>, void>>
+inline Checker range_list(T lo, T hi)
+{
+  return Checker([lo, hi](const std::string& p, const std::string& v) -> checker_ret_t {
+    std::vector<T> values;
+    auto [res, msg] = utils::parse_range_list<T>(v, values, lo, hi);
+    return std::make_tuple(res, utils::format_error(p, v, msg));
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief match checker factory, passes if the whole value matches a regex
+ *
+ * The regex is compiled into a utils::Dfa once, checking a value is linear and doesn't
+ * allocate unless it fails.
+ * @code
+ * auto sample_id = check::f::match("[A-Z]{2}[0-9]{4}(_R[12])?");
+ * throw_if_false(sample_id("--sample", "AB1234_R1"));
+ * @endcode
+ * @see utils::Dfa
+ * @param regex
+ * @return Checker
+ */
+inline Checker match(const std::string& regex)
+{
+  auto dfa = std::make_shared<const utils::Dfa>(regex);
+  return Checker([dfa, regex](const std::string& p, const std::string& v) -> checker_ret_t {
+    if (dfa->match(v))
+      return std::make_tuple(true, std::string());
+    return std::make_tuple(false, utils::format_error(p, v, "Doesn't match " + regex + "."));
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief glob checker factory, passes if the whole value matches a glob pattern
+ *
+ * @code
+ * auto run_name = check::f::glob("run_{hiseq,novaseq}_*");
+ * @endcode
+ * @see match
+ * @param pattern
+ * @return Checker
+ */
+inline Checker glob(const std::string& pattern)
+{
+  auto dfa = std::make_shared<const utils::Dfa>(utils::Dfa::from_glob(pattern));
+  return Checker([dfa, pattern](const std::string& p, const std::string& v) -> checker_ret_t {
+    if (dfa->match(v))
+      return std::make_tuple(true, std::string());
+    return std::make_tuple(false, utils::format_error(p, v, "Doesn't match " + pattern + "."));
+  }, Cost::Pure);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief all_of checker factory, passes if all checkers pass
+ *
+ * Checkers are evaluated by increasing cost, until one fails.
+ * @code
+ * auto gz_fasta = f::all_of({check::is_gz, check::seems_gz, check::is_file});
+ * // -> seems_gz, is_file, then is_gz
+ * @endcode
+ * @param checkers
+ * @return Checker
+ */
+inline Checker all_of(std::vector<Checker> checkers)
+{
+  sort_by_cost(checkers);
+  Cost cost = checkers.empty() ? Cost::Pure : checkers.back().cost();
+  return Checker([checkers](const std::string& p, const std::string& v) {
+    return eval_all(checkers, p, v);
+  }, cost);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief any_of checker factory, passes if at least one checker passes
+ *
+ * Checkers are evaluated by increasing cost, until one passes.
+ * @param checkers
+ * @return Checker
+ */
+inline Checker any_of(std::vector<Checker> checkers)
+{
+  sort_by_cost(checkers);
+  Cost cost = checkers.empty() ? Cost::Pure : checkers.back().cost();
+  return Checker([checkers](const std::string& p, const std::string& v) {
+    return eval_any(checkers, p, v);
+  }, cost);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief none_of checker factory, passes if no checker passes
+ *
+ * Checkers are evaluated by increasing cost, until one passes.
+ * @param checkers
+ * @return Checker
+ */
+inline Checker none_of(std::vector<Checker> checkers)
+{
+  sort_by_cost(checkers);
+  Cost cost = checkers.empty() ? Cost::Pure : checkers.back().cost();
+  return Checker([checkers](const std::string& p, const std::string& v) {
+    return eval_none(checkers, p, v);
+  }, cost);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief xor_of checker factory, passes if exactly one checker passes
+ *
+ * Checkers are evaluated by increasing cost, until a second one passes.
+ * @param checkers
+ * @return Checker
+ */
+inline Checker xor_of(std::vector<Checker> checkers)
+{
+  sort_by_cost(checkers);
+  Cost cost = checkers.empty() ? Cost::Pure : checkers.back().cost();
+  return Checker([checkers](const std::string& p, const std::string& v) {
+    return eval_one(checkers, p, v);
+  }, cost);
+}
+
+/**
+ * @ingroup Checkers
+ * @brief timeout checker factory, fails if the checker doesn't return in time
+ *
+ * @code
+ * cli.add_param("-r/--ref", "reference")
+ *   ->checker(f::timeout(check::is_file, std::chrono::seconds(5)));
+ * @endcode
+ * @param checker
+ * @param timeout
+ * @return Checker
+ */
+inline Checker timeout(Checker checker, std::chrono::milliseconds timeout)
+{
+  return checker.with_timeout(timeout);
+}
+
+} // end of namespace f (checker factories)
+
+/**
+ * @ingroup Checkers
+ * @brief fastx ext checker
+ *
+ */
+inline Checker seems_fastx = f::ext("fa|fna|fasta|fastq|fq");
+
+/**
+ * @ingroup Checkers
+ * @brief fasta ext checker
+ *
+ */
+inline Checker seems_fasta = f::ext("fa|fna|fasta");
+
+/**
+ * @ingroup Checkers
+ * @brief fastq ext checker
+ *
+ */
+inline Checker seems_fastq = f::ext("fastq|fq");
+
+/**
+ * @ingroup Checkers
+ * @brief sam ext checker
+ *
+ */
+inline Checker seems_sam = f::ext("sam");
+
+/**
+ * @ingroup Checkers
+ * @brief bam ext checker
+ *
+ */
+inline Checker seems_bam = f::ext("bam");
+
+/**
+ * @ingroup Checkers
+ * @brief cram ext checker
+ *
+ */
+inline Checker seems_cram = f::ext("cram");
+
+/**
+ * @ingroup Checkers
+ * @brief comp ext checker
+ *
+ */
+inline Checker seems_comp = f::ext("gz|bz2|lz4");
+
+/**
+ * @ingroup Checkers
+ * @brief gz ext checker
+ *
+ */
+inline Checker seems_gz = f::ext("gz");
+
+/**
+ * @ingroup Checkers
+ * @brief fastx
+ *
+ */
+inline Checker seems_lz4 = f::ext("lz4");
+
+/**
+ * @ingroup Checkers
+ * @brief gz checker
+ *
+ */
+inline Checker is_gz = f::check_magic<2>("gz", {0x1F, 0x8B});
+
+/**
+ * @ingroup Checkers
+ * @brief lz4_frame checker
+ *
+ */
+inline Checker is_lz4_frame = f::check_magic<4>("lz4frame", {0x04, 0x22, 0x4D, 0x18});
+
+/**
+ * @ingroup Checkers
+ * @brief bz2 checker
+ *
+ */
+inline Checker is_bz2 = f::check_magic<3>("bz2", {0x42, 0x5A, 0x68});
+
+/**
+ * @ingroup Checkers
+ * @brief bam checker
+ *
+ */
+inline Checker is_bam = f::check_magic<4>("bam", {0x1F, 0x8B, 0x08, 0x04});
+
+/**
+ * @ingroup Checkers
+ * @brief cram checker
+ *
+ */
+inline Checker is_cram = f::check_magic<4>("cram", {0x43, 0x52, 0x41, 0x4d});
+
+} // end of namespace checker
+
+
+
+/**
+ * @defgroup Providers
+ * @brief About bcli default providers.
+ *
+ * Default providers are functions consulted before Param::process_def. If a provider
+ * returns a value, it replaces the static default of the parameter (but never a value
+ * set by the user). They are mainly used to pull defaults from batch-scheduler
+ * environments (SLURM, PBS, SGE).
+ *
+ * A provider returns std::optional<std::string>, std::nullopt means nothing to provide.
+ *
+ * Two namespaces:
+ *  - provider -> contains providers
+ *  - provider::f -> contains factories
+ */
+
+/**
+ * @namespace provider
+ * @ingroup Providers
+ * @brief bcli default provider namespace
+ *
+ */
+namespace provider {
+
+/**
+ * @typedef provider_ret_t
+ * @ingroup Providers
+ * @brief providers return type
+ *
+ */
+using provider_ret_t = std::optional<std::string>;
+
+/**
+ * @typedef provider_fn_t
+ * @ingroup Providers
+ * @brief providers function signature
+ *
+ */
+using provider_fn_t = std::function<provider_ret_t()>;
+
+/**
+ * @namespace f
+ * @ingroup Providers
+ * @brief bcli provider factories namespace
+ *
+ */
+namespace f {
+
+/**
+ * @ingroup Providers
+ * @brief environment variable provider factory
+ *
+ * @code
+ * auto cpus = provider::f::env("SLURM_CPUS_PER_TASK");
+ * @endcode
+ * @param var variable name
+ * @return provider_fn_t, std::nullopt if var is unset or empty
+ */
+inline provider_fn_t env(const std::string& var)
+{
+  return [var]() -> provider_ret_t {
+    const char* value = std::getenv(var.c_str());
+    if (value == nullptr || *value == '\0')
+      return std::nullopt;
+    return std::string(value);
+  };
+}
+
+/**
+ * @ingroup Providers
+ * @brief first_of provider factory
+ *
+ * Returns the value of the first provider that provides something.
+ *
+ * @param providers
+ * @return provider_fn_t
+ */
+inline provider_fn_t first_of(std::vector<provider_fn_t> providers)
+{
+  return [providers]() -> provider_ret_t {
+    for (auto& p : providers)
+      if (auto value = p(); value)
+        return value;
+    return std::nullopt;
+  };
+}
+
+/**
+ * @ingroup Providers
+ * @brief number provider factory
+ *
+ * Forwards the value of a provider only if it is a positive integer, then applies
+ * op on it. Scheduler variables can be malformed (ex: SLURM_CPUS_PER_TASK="2(x3)"),
+ * in this case nothing is provided.
+ *
+ * @param provider
+ * @param op
+ * @return provider_fn_t
+ */
+inline provider_fn_t number(provider_fn_t provider,
+                            std::function<uint64_t(uint64_t)> op = nullptr)
+{
+  return [provider, op]() -> provider_ret_t {
+    auto value = provider();
+    if (!value)
+      return std::nullopt;
+    uint64_t n = 0;
+    const char* end = value->data() + value->size();
+    auto [ptr, ec] = std::from_chars(value->data(), end, n);
+    if (ec != std::errc() || ptr != end || n == 0)
+      return std::nullopt;
+    if (op)
+      n = op(n);
+    return std::to_string(n);
+  };
+}
+
+} // end of namespace f (provider factories)
+
+/**
+ * @ingroup Providers
+ * @brief number of allocated cores
+ *
+ * SLURM_CPUS_PER_TASK (SLURM), PBS_NUM_PPN (PBS/Torque), NSLOTS (SGE).
+ */
+inline provider_fn_t nb_cores = f::number(f::first_of({
+  f::env("SLURM_CPUS_PER_TASK"), f::env("PBS_NUM_PPN"), f::env("NSLOTS")
+}));
+
+/**
+ * @ingroup Providers
+ * @brief allocated memory per node, in MB
+ *
+ * SLURM_MEM_PER_NODE, or SLURM_MEM_PER_CPU x allocated cores.
+ */
+inline provider_fn_t memory_per_node = f::first_of({
+  f::number(f::env("SLURM_MEM_PER_NODE")),
+  f::number(f::env("SLURM_MEM_PER_CPU"), [](uint64_t mem) -> uint64_t {
+    auto cores = nb_cores();
+    return cores ? mem * std::stoull(*cores) : mem;
+  })
+});
+
+/**
+ * @ingroup Providers
+ * @brief allocated memory per core, in MB
+ *
+ * SLURM_MEM_PER_CPU, or SLURM_MEM_PER_NODE / allocated cores.
+ */
+inline provider_fn_t memory_per_core = f::first_of({
+  f::number(f::env("SLURM_MEM_PER_CPU")),
+  f::number(f::env("SLURM_MEM_PER_NODE"), [](uint64_t mem) -> uint64_t {
+    auto cores = nb_cores();
+    return cores ? std::max<uint64_t>(mem / std::stoull(*cores), 1) : mem;
+  })
+});
+
+/**
+ * @ingroup Providers
+ * @brief scheduler-provided tmp dir
+ *
+ * TMPDIR, set per job by most schedulers.
+ */
+inline provider_fn_t tmp_dir = f::env("TMPDIR");
+
+} // end of namespace provider
+
+/**
+ * @defgroup Param
+ * @brief About bcli parameters
+ */
+
+const std::string FLAG_VALUE = "BCLI_FSET";
+
+/**
+ * @ingroup Param
+ * @enum Action
+ * @brief parameter actions
+ *
+ */
+enum Action
+{
+  Nothing,     /*!< Nothing  */
+  ShowHelp,    /*!< Trigger help */
+  ShowVersion  /*!< Trigger version */
+};
+
+/**
+ * @ingroup Param
+ * @enum FileFormat
+ * @brief number file formats, see Param::from_file
+ *
+ */
+enum class FileFormat
+{
+  Text,   /*!< Numbers as text, sep by whitespaces, ',' or ';' */
+  Binary  /*!< Raw native numbers */
+};
+
+/**
+ * @namespace param
+ * @brief bcli param namespace
+ *
+ *
+ */
+namespace param {
+
+class Param;
+
+/**
+ * @ingroup Param
+ * @typedef param_t
+ * @brief param_t
+ *
+ * Param constuctor is private, Param is always used as std::shared_ptr<Param>
+ */
+using param_t = std::shared_ptr<Param>;
+
+/**
+ * @ingroup Param
+ * @typedef checker_fn_t
+ * @brief checker function signature
+ *
+ *
+ */
+using checker_fn_t = check::checker_fn_t;
+
+/**
+ * @ingroup Param
+ * @typedef setter_fn_t
+ * @brief setter function signature
+ *
+ */
+using setter_fn_t = std::function<void(const std::string&)>;
+
+/**
+ * @ingroup Param
+ * @typedef help_fn_t
+ * @brief help function signature
+ *
+ */
+using help_fn_t = std::function<std::string()>;
+
+/**
+ * @ingroup Param
+ * @typedef callback_fn_t
+ * @brief callback function signature
+ *
+ */
+using callback_fn_t = std::function<void()>;
+
+using conf = config::Config;
+
+/**
+ * @ingroup Param
+ * @typedef provider_fn_t
+ * @brief default provider function signature
+ *
+ */
+using provider_fn_t = provider::provider_fn_t;
+
+/**
+ * @brief get a setter from variable reference
+ *
+ * Returns a setter to set T var. If T is a std::vector, values are appended.
+ *
+ * @tparam T
+ * @param var variable to set
+ * @return setter_fn_t
+ */
+template<typename T>
+setter_fn_t get_setter(T& var)
+{
+  return [&var] (const std::string& in = {}) {
+    if constexpr(std::is_same_v<T, bool>)
+    {
+      if (in == FLAG_VALUE)
+        var = true;
+      else
+        var = false;
+    }
+    else if constexpr(utils::is_vector_v<T>)
+    {
+      var.push_back(utils::from_string<typename T::value_type>(in));
+    }
+    else
+    {
+      var = utils::lexical_cast<T>(in);
+    }
+  };
+}
+
+/**
+ * @ingroup Param
+ * @brief RangeList
+ *
+ * A parameter type for range lists (ex: "15-31:2,41,51-63"), usable with Param::as and
+ * Param::setter.
+ *
+ * @code
+ * cli.add_param("--kmer-sizes", "k-mer sizes")->checker(check::f::range_list(15, 63));
+ * ...
+ * auto ks = cli.getp("kmer-sizes")->as<RangeList<int>>();
+ * for (int k : ks) {}
+ * @endcode
+ *
+ * @see utils::parse_range_list
+ * @tparam T An integral type
+ */
+template<typename T = int>
+class RangeList
+{
+public:
+  RangeList() = default;
+
+  RangeList(const std::string& s)
+  {
+    auto [res, msg] = utils::parse_range_list<T>(s, m_values);
+    if (!res)
+      BCLI_THROW(ex::LexicalCastError("Unable to cast \"" + s + "\" to a range list: " + msg));
+  }
+
+  /**
+   * @brief get sorted values
+   *
+   * @return const std::vector<T>&
+   */
+  const std::vector<T>& values() const { return m_values; }
+
+  /**
+   * @brief get values as a dynamic bitset, bitset[v] is true if v is in the list
+   *
+   * Requires non-negative values.
+   *
+   * @return std::vector<bool>
+   */
+  std::vector<bool> bitset() const
+  {
+    if (m_values.empty())
+      return {};
+    assert(m_values.front() >= 0);
+    std::vector<bool> bits(static_cast<size_t>(m_values.back()) + 1, false);
+    for (auto& v : m_values)
+      bits[static_cast<size_t>(v)] = true;
+    return bits;
+  }
+
+  bool contains(T v) const
+  {
+    return std::binary_search(m_values.begin(), m_values.end(), v);
+  }
+
+  size_t size() const { return m_values.size(); }
+  bool empty() const { return m_values.empty(); }
+  T operator[](size_t i) const { return m_values[i]; }
+
+  auto begin() const { return m_values.begin(); }
+  auto end() const { return m_values.end(); }
+
+PRIVATE:
+  std::vector<T> m_values;
+};
+
+/**
+ * @ingroup Param
+ * @brief how the checkers of a param are combined, see Param::checker_mode
+ */
+enum CheckerMode
+{
+  AND, /*!< All checkers must pass. */
+  OR,  /*!< At least one checker must pass. */
+  XOR  /*!< Exactly one checker must pass. */
+};
+
+/**
+ * @ingroup Param
+ * @brief handle_t
+ *
+ * A lightweight handle on a param, an index into the frozen schema of a parser.
+ * @see Parser::handle
+ */
+struct handle_t
+{
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  uint32_t id {npos};
+
+  bool valid() const { return id != npos; }
+};
+
+/**
+ * @ingroup Param
+ * @brief Param::as return type, std::vector are returned by const reference
+ */
+template<typename T>
+struct as_ret {using type = T;};
+
+template<typename T>
+struct as_ret<std::vector<T>> {using type = const std::vector<T>&;};
+
+/**
+ * @ingroup Param
+ * @brief relational operators, see Param::relation
+ */
+enum class Rel
+{
+  Lt, /*!< < */
+  Le, /*!< <= */
+  Gt, /*!< > */
+  Ge, /*!< >= */
+  Eq, /*!< == */
+  Ne  /*!< != */
+};
+
+/**
+ * @ingroup Param
+ * @brief what to do with duplicate input files, see Command::dedup_inputs
+ */
+enum class Dedup
+{
+  Drop, /*!< keep the first occurrence */
+  Error /*!< raise a DuplicateInputError */
+};
+
+/**
+ * @ingroup Param
+ * @brief State
+ *
+ * Per-parse state of a parameter, everything else in a Param is schema.
+ */
+struct State
+{
+  std::string              m_str_value {};
+  std::vector<std::string> m_str_values {};
+  std::vector<uint8_t>     m_checked {}; // values already checked by an expansion
+  std::any                 m_values {};
+  std::unordered_map<std::type_index, std::any> m_converted {};
+  std::shared_future<std::tuple<bool, std::string>> m_async {};
+
+  bool m_has_valid_value {false};
+  bool m_is_set          {false};
+  bool m_as_default      {false};
+  bool m_def_unchecked   {false};
+
+  /**
+   * @brief get values as std::vector<T>, see Param::values
+   *
+   * Conversions to other types than the typed storage are cached per type, references
+   * stay valid until the values change.
+   *
+   * @tparam T
+   * @param multi true for a multi-value param
+   * @return const std::vector<T>&
+   */
+  template<typename T>
+  const std::vector<T>& values(bool multi)
+  {
+    if (auto typed = std::any_cast<std::vector<T>>(&m_values))
+      return *typed;
+    // the typed storage is kept, other types go to a cache that never moves its entries
+    std::any& slot = m_values.has_value() ? m_converted[std::type_index(typeid(std::vector<T>))]
+                                          : m_values;
+    if (auto typed = std::any_cast<std::vector<T>>(&slot))
+      return *typed;
+
+    std::vector<T> converted;
+    if (multi)
+    {
+      converted.reserve(m_str_values.size());
+      for (auto& v : m_str_values)
+        converted.push_back(utils::from_string<T>(v));
+    }
+    else if (!m_str_value.empty())
+      converted.push_back(utils::from_string<T>(m_str_value));
+    slot = std::move(converted);
+    return *std::any_cast<std::vector<T>>(&slot);
+  }
+
+  void clear_values()
+  {
+    m_values.reset();
+    m_converted.clear();
+  }
+
+  /**
+   * @brief clear the state, buffers are kept
+   *
+   * @param def default value
+   */
+  void reset(const std::string& def)
+  {
+    m_str_value = def;
+    m_str_values.clear();
+    m_checked.clear();
+    clear_values();
+    m_async = {};
+    m_has_valid_value = false;
+    m_is_set = false;
+    m_as_default = false;
+    m_def_unchecked = false;
+  }
+};
+
+/**
+ * @ingroup Param
+ * @brief result of the checkers on a static default, computed at most once
+ */
+struct DefaultCheck
+{
+  std::once_flag       once;
+  check::checker_ret_t rc {true, ""};
+};
+
+class ParamGroup;
+class Constraints;
+
+/**
+ * @ingroup Param
+ * @brief Param
+ *
+ * Parameter class
+ */
+class Param: public std::enable_shared_from_this<Param>, PRIVATE State
+{
+  using s_ptr = std::shared_ptr<Param>;
+  friend param_t make(const std::string& name,
+                      const std::string& help,
+                      setter_fn_t setter,
+                      checker_fn_t checker);
+
+  friend class ParamTest;
+  friend class ParamGroup;
+  friend class Command;
+  friend class Parser<0>;
+  friend class Parser<1>;
+  friend class bc::Result;
+  friend class Constraints;
+
+public:
+  /**
+   * @brief get idx
+   *
+   * @return std::tuple<std::string, std::string>
+   */
+  std::tuple<std::string, std::string> idx()
+  {
+    return std::make_tuple(m_short, m_long);
+  }
+
+  /**
+   * @brief get raw name
+   *
+   * @return std::string
+   */
+  std::string raw()
+  {
+    return m_raw_name;
+  }
+
+  /**
+   * @brief set default value
+   *
+   * @param default_value
+   * @return param_t
+   */
+  param_t def(const std::string& default_value)
+  {
+    m_default = default_value;
+    m_str_value = m_default;
+    m_has_default = true;
+    m_def_check = std::make_shared<DefaultCheck>();
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set default provider
+   *
+   * The provider is consulted at each parse if the parameter is not set by the user.
+   * A provided value takes precedence over the static default.
+   *
+   * @code
+   * cli.add_param("--nb-cores", "number of cores")
+   *   ->def("8")->def_provider(bc::provider::nb_cores);
+   * @endcode
+   *
+   * @see Providers
+   *
+   * @param provider
+   * @return param_t
+   */
+  param_t def_provider(provider_fn_t provider)
+  {
+    c_def_provider = provider;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set checker
+   *
+   * Builtin checkers carry their cost (see check::Cost). Other callables, as
+   * std::function or lambdas, are classed Cost::Full unless a cost is given, see
+   * Param::checker(checker_fn_t, check::Cost).
+   *
+   * @param checker_callback
+   * @return param_t
+   */
+  param_t checker(check::Checker checker_callback)
+  {
+    if (m_is_flag)
+    {
+      ex::ExHandler::get().push(
+        ex::IncompatibleError(utils::wrap(m_raw_name, "[]") + "~ A flag cannot have a checker."));
+    }
+    c_checkers.push_back(checker_callback);
+    check::sort_by_cost(c_checkers);
+    m_def_check = std::make_shared<DefaultCheck>();
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set checker with its cost
+   *
+   * @code
+   * cli.add_param("-i", "index")->checker(is_valid_index, check::Cost::Header);
+   * @endcode
+   *
+   * @param checker_callback
+   * @param cost cost class, orders the evaluation and enables the parse deadline
+   * @return param_t
+   */
+  param_t checker(checker_fn_t checker_callback, check::Cost cost)
+  {
+    return checker(check::Checker(std::move(checker_callback), cost));
+  }
+
+  /**
+   * @brief set an expensive checker, run in background
+   *
+   * The checker is queued on utils::TaskPool once the other checkers pass, and parsing
+   * goes on. Its result is waited for on the first access to the value, or by
+   * Parser::sync, where a failure is thrown. Setters don't wait for it. Costs and the
+   * parse deadline apply as for Param::checker.
+   *
+   * @code
+   * cli.add_param("-i/--index", "index")->checker(check::is_file)
+   *   ->checker_async(check::f::check_magic<4>("idx", {0x49, 0x44, 0x58, 0x31}));
+   * BCLI_PARSE(cli, argc, argv)
+   * load_reference(); // overlaps with the check
+   * cli.sync();
+   * @endcode
+   *
+   * @param checker_callback
+   * @return param_t
+   */
+  param_t checker_async(check::Checker checker_callback)
+  {
+    if (m_is_flag)
+    {
+      ex::ExHandler::get().push(
+        ex::IncompatibleError(utils::wrap(m_raw_name, "[]") + "~ A flag cannot have a checker."));
+    }
+    // copied, tasks still running keep the previous list
+    auto checkers = std::make_shared<std::vector<check::Checker>>(*c_async_checkers);
+    checkers->push_back(checker_callback);
+    c_async_checkers = std::move(checkers);
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set how checkers are combined
+   *
+   * Whatever the mode, checkers are evaluated by increasing cost (see check::Cost)
+   * and the evaluation stops as soon as the result is known.
+   *
+   * @param mode
+   * @return param_t
+   */
+  param_t checker_mode(CheckerMode mode)
+  {
+    m_check_mode = mode;
+    m_def_check = std::make_shared<DefaultCheck>();
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set setter (auto from variable reference)
+   *
+   * @tparam T
+   * @param var
+   * @return param_t
+   */
+  template<typename T>
+  param_t setter(T& var)
+  {
+    c_setter = get_setter<T>(var);
+    c_clear = nullptr;
+    if constexpr(utils::is_vector_v<T>)
+      c_clear = [&var]() { var.clear(); };
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set setter
+   *
+   * @param setter_callback
+   * @return param_t
+   */
+  param_t setter_c(setter_fn_t setter_callback)
+  {
+    c_setter = setter_callback;
+    c_clear = nullptr;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set callback
+   *
+   * Callback is called if parameter is used by user.
+   *
+   * @param callback
+   * @return param_t
+   */
+  param_t callback(callback_fn_t callback)
+  {
+    c_callback = callback;
+    m_callback_trigger = true;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set dependencies
+   *
+   * see @link 04_bcli_deps_bans.cpp @endlink
+   *
+   * @param checker
+   * @param p
+   * @param pchecker
+   * @return param_t
+   */
+  param_t depends_on(check::checker_fn_t checker, param_t p, check::checker_fn_t pchecker = nullptr)
+  {
+    m_depends_on.push_back({checker, p, pchecker});
+    return shared_from_this();
+  }
+
+  /**
+   * @brief
+   *
+   * see @link 04_bcli_deps_bans.cpp @endlink
+   *
+   * @param checker
+   * @param p
+   * @param pchecker
+   * @return param_t
+   */
+  param_t banned(check::checker_fn_t checker, param_t p, check::checker_fn_t pchecker = nullptr)
+  {
+    m_banned.push_back({checker, p, pchecker});
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set a relational constraint with another numeric param
+   *
+   * Checked when both params have a value.
+   *
+   * @code
+   * amax->relation(Rel::Gt, amin); // --abundance-max > --abundance-min
+   * @endcode
+   *
+   * @param rel
+   * @param p
+   * @return param_t
+   */
+  param_t relation(Rel rel, param_t p)
+  {
+    m_relations.push_back({rel, p});
+    return shared_from_this();
+  }
+
+  /**
+   * @brief use param as flag (without value)
+   *
+   * @return param_t
+   */
+  param_t as_flag()
+  {
+    if (!c_checkers.empty() || !c_async_checkers->empty())
+    {
+      ex::ExHandler::get().push(
+        ex::IncompatibleError(
+          utils::wrap(m_raw_name, "[]") + "~ A param with checker cannot be a flag."));
+    }
+    m_is_flag = true;
+    m_has_default = true;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set metavar
+   *
+   * Metavar shown in usage: \n
+   * meta("INT") -> -i/--integer <INT> \n
+   * meta("FILE") -> --file <FILE> \n
+   *
+   * @param meta
+   * @return param_t
+   */
+  param_t meta(const std::string& meta)
+  {
+    m_meta = meta;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief set action
+   *
+   * @see bc::Action
+   *
+   * @param action
+   * @return param_t
+   */
+  param_t action(Action action)
+  {
+    m_action = action;
+    return shared_from_this();
+  }
+
+  param_t hide()
+  {
+    m_hidden = true;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief use param as multi-value param
+   *
+   * Values are accumulated over repeated uses (-i a -i b) and split on sep (-i a,b,c).
+   * Values are stored as std::vector<T>, see Param::values and Param::as.
+   * Checkers are run on each value, in bulk, after all arguments are read.
+   *
+   * @code
+   * cli.add_param("-i/--inputs", "input files")->multi<std::string>(64)
+   *   ->checker(check::is_file)->parallel_checks();
+   * ...
+   * const std::vector<std::string>& inputs = cli.getp("i")->as<std::vector<std::string>>();
+   * @endcode
+   *
+   * @tparam T value type
+   * @param size_hint expected number of values
+   * @param sep value separator, '\0' to disable splitting
+   * @return param_t
+   */
+  template<typename T = std::string>
+  param_t multi(size_t size_hint = 0, char sep = ',')
+  {
+    if (m_is_flag)
+    {
+      ex::ExHandler::get().push(
+        ex::IncompatibleError(utils::wrap(m_raw_name, "[]") + "~ A flag cannot be multi-value."));
+    }
+    m_is_multi = true;
+    m_sep = sep;
+    m_size_hint = size_hint;
+    c_typed = [](const std::string& p, const std::vector<std::string>& in, std::any& out)
+      -> check::checker_ret_t {
+      std::vector<T> values;
+      values.reserve(in.size());
+      for (auto& v : in)
+      {
+        T value {};
+        if (!utils::try_from_string(v, value))
+          return std::make_tuple(false, utils::format_error(p, v, "Invalid value."));
+        values.push_back(std::move(value));
+      }
+      out = std::move(values);
+      return std::make_tuple(true, "");
+    };
+    return shared_from_this();
+  }
+
+  /**
+   * @brief load values from a file
+   *
+   * The param value is a path to a file of numbers, loaded as std::vector<T>
+   * (see Param::values and Param::as) after the param checkers. Bounds are checked
+   * in bulk on the loaded values.
+   *
+   * @code
+   * cli.add_param("--ids-file", "ids")->checker(check::is_file)
+   *   ->from_file<uint32_t>(FileFormat::Text, 0, 1000000);
+   * ...
+   * const std::vector<uint32_t>& ids = cli.getp("ids-file")->as<std::vector<uint32_t>>();
+   * @endcode
+   *
+   * @tparam T An arithmetic type
+   * @param format text or raw binary
+   * @param lo lower bound
+   * @param hi upper bound
+   * @return param_t
+   */
+  template<typename T,
+           typename = typename std::enable_if_t<std::is_arithmetic_v<T>, void>>
+  param_t from_file(FileFormat format = FileFormat::Text,
+                    T lo = std::numeric_limits<T>::lowest(),
+                    T hi = std::numeric_limits<T>::max())
+  {
+    c_loader = [format, lo, hi](const std::string& p, const std::string& v, std::any& out)
+      -> check::checker_ret_t {
+      std::vector<T> values;
+      auto [res, msg] = format == FileFormat::Text ? utils::load_numbers<T>(v, values)
+                                                   : utils::load_binary_numbers<T>(v, values);
+      if (!res)
+        return std::make_tuple(false, utils::format_error(p, v, msg));
+
+      size_t nb_out = 0, first = 0;
+      for (size_t i=0; i<values.size(); i++)
+      {
+        if (!(values[i] >= lo && values[i] <= hi))
+        {
+          if (nb_out++ == 0)
+            first = i;
+        }
+      }
+      if (nb_out > 0)
+      {
+        return std::make_tuple(false, utils::format_error(p, v,
+          std::to_string(nb_out) + " values not in range [" + std::to_string(lo) + ","
+          + std::to_string(hi) + "], first at index " + std::to_string(first) + "."));
+      }
+      out = std::move(values);
+      return std::make_tuple(true, "");
+    };
+    return shared_from_this();
+  }
+
+  /**
+   * @brief run checkers of a multi-value param in parallel
+   *
+   * Useful for expensive checkers like file checkers. Checkers must be thread-safe.
+   *
+   * @param nb_threads number of threads, 0 -> std::thread::hardware_concurrency()
+   * @return param_t
+   */
+  param_t parallel_checks(size_t nb_threads = 0)
+  {
+    m_nb_threads = nb_threads == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1)
+                                   : nb_threads;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief expand values of a multi-value param which are globs or directories
+   *
+   * Files are kept if they pass the param checkers, see utils::expand_path.
+   *
+   * @code
+   * cli.add_param("-r/--reads", "reads")->multi()->checker(check::seems_fastq)->expand();
+   * // app -r 'runs/sample_*'
+   * @endcode
+   * @param nb_threads number of threads of the directory walker, 0 -> all
+   * @return param_t
+   */
+  param_t expand(size_t nb_threads = 0)
+  {
+    m_expand = true;
+    m_expand_threads = nb_threads;
+    return shared_from_this();
+  }
+
+  /**
+   * @brief get str value
+   *
+   * @return const std::string&
+   */
+  const std::string& value()
+  {
+    check_value(*this);
+    return m_str_value;
+  }
+
+  /**
+   * @brief get default value
+   *
+   * @return const std::string&
+   */
+  const std::string& get_def()
+  {
+    return m_default;
+  }
+
+  /**
+   * @brief check if param is set
+   *
+   * @return true
+   * @return false
+   */
+  bool is_set()
+  {
+    return m_is_set;
+  }
+
+  /**
+   * @brief get param value
+   *
+   * Support:
+   * - Arithmetic types (int, float, double...)
+   * - bool
+   * - std::string
+   *
+   * Example:
+   * @code
+   * bc::param_t p;
+   * int v = p->as<int>();
+   * @endcode
+   *
+   * @endcode
+   *
+   * Extend for custom types:
+   * @code
+   * class MyClass
+   * {
+   * public:
+   *   MyClass(std::string one, int i) {}
+   * };
+   *
+   * template<>
+   * MyClass bc::param::Param::as<MyClass>()
+   * {
+   *   return MyClass(m_str_value, 10);
+   * }
+   * @endcode
+   * Then:
+   * @code
+   * bc::param_t p;
+   * MyClass c = p->as<MyClass>();
+   * @endcode
+   *
+   *
+   * std::vector<T> are returned by const reference, see Param::values.
+   *
+   * @tparam T
+   * @return T
+   */
+  template<typename T, typename R = typename as_ret<T>::type>
+  R as()
+  {
+    if constexpr(std::is_same_v<T, bool>)
+      return m_is_set;
+    else if constexpr(utils::is_vector_v<T>)
+      return values<typename T::value_type>();
+    else
+    {
+      check_value(*this);
+      return utils::lexical_cast<T>(m_str_value);
+    }
+  }
+
+  /**
+   * @brief get values as std::vector<T>
+   *
+   * For a multi-value param declared with the same T, the typed storage is returned
+   * without conversion. Otherwise, values are converted once and cached.
+   *
+   * @tparam T
+   * @return const std::vector<T>&
+   */
+  template<typename T>
+  const std::vector<T>& values()
+  {
+    check_value(*this);
+    return State::values<T>(m_is_multi);
+  }
+
+  /**
+   * @brief get raw values of a multi-value param
+   *
+   * @return const std::vector<std::string>&
+   */
+  const std::vector<std::string>& str_values()
+  {
+    return m_str_values;
+  }
+
+PRIVATE:
+  Param(const std::string& name,
+        const std::string& help,
+        setter_fn_t setter,
+        checker_fn_t checker)
+    : m_raw_name(name), m_help(help), c_setter(setter)
+  {
+    for (auto& v : utils::split(name, '/'))
+    {
+      if (utils::is_short_param(v))
+        m_short = utils::trim_param(v);
+      else if (utils::is_long_param(v))
+        m_long = utils::trim_param(v);
+      else
+      {
+        ex::ExHandler::get().push(
+          ex::InvalidParamError(
+            name + " -> " + utils::wrap(v, "\"\"") + " is neither a valid short nor a valid long param")
+         );
+      }
+      m_has_pname = true;
+    }
+    if (checker) c_checkers.push_back(checker);
+  }
+
+  const std::vector<std::tuple<checker_fn_t, param_t, checker_fn_t>>& get_dependency()
+  {
+    return m_depends_on;
+  }
+
+  const std::vector<std::tuple<checker_fn_t, param_t, check::checker_fn_t>>& get_banned()
+  {
+    return m_banned;
+  }
+
+  bool is_required()
+  {
+    return !m_has_default;
+  }
+
+  void set()
+  {
+    set(*this);
+  }
+
+  std::string sp() const
+  {
+    if (m_short.empty())
+      return m_short;
+    return std::string("-") + m_short;
+  }
+
+  std::string lp() const
+  {
+    if (m_long.empty())
+      return m_long;
+    return std::string("--") + m_long;
+  }
+
+  bool hidden() const
+  {
+    return m_hidden;
+  }
+
+  Action get_action() const
+  {
+    return m_action;
+  }
+
+  const std::string& get_help() const
+  {
+    return m_help;
+  }
+
+  const std::string& get_meta() const
+  {
+    return m_meta;
+  }
+
+  bool has_short()
+  {
+    return !m_short.empty();
+  }
+
+  bool has_long()
+  {
+    return !m_long.empty();
+  }
+
+  bool has_both()
+  {
+    return has_short() && has_long();
+  }
+
+  bool is_flag()
+  {
+    return m_is_flag;
+  }
+
+  bool is_multi()
+  {
+    return m_is_multi;
+  }
+
+  uint32_t id() const
+  {
+    return m_id;
+  }
+
+  void push_values(State& st, const std::string& value) const
+  {
+    if (st.m_str_values.empty())
+      st.m_str_values.reserve(m_size_hint);
+    size_t first = st.m_str_values.size();
+    if (m_sep == '\0')
+      st.m_str_values.push_back(value);
+    else
+    {
+      std::string_view sv(value);
+      for (size_t beg = 0, end; beg <= sv.size(); beg = end + 1)
+      {
+        end = sv.find(m_sep, beg);
+        if (end == std::string_view::npos)
+          end = sv.size();
+        st.m_str_values.emplace_back(sv.substr(beg, end - beg));
+      }
+    }
+    if (m_expand)
+    {
+      std::vector<std::string> values(std::make_move_iterator(st.m_str_values.begin() + first),
+                                      std::make_move_iterator(st.m_str_values.end()));
+      st.m_str_values.resize(first);
+      st.m_checked.resize(first, 0);
+      for (auto& v : values)
+      {
+        std::error_code ec;
+        if (!utils::is_glob(v) && !fs::is_directory(v, ec))
+        {
+          st.m_str_values.push_back(std::move(v));
+          st.m_checked.push_back(0);
+          continue;
+        }
+        auto until = check::parse_deadline();
+        auto files = utils::expand_path(v, m_expand_threads, [this, until](const std::string& f) {
+          check::Deadline deadline(until);
+          return std::get<0>(run_checkers(f));
+        });
+        // files kept by the expansion passed the checkers, see process_multi
+        bool checked = files.size() != 1 || files[0] != v;
+        st.m_checked.insert(st.m_checked.end(), files.size(), checked);
+        st.m_str_values.insert(st.m_str_values.end(), std::make_move_iterator(files.begin()),
+                               std::make_move_iterator(files.end()));
+      }
+    }
+  }
+
+  void process(const std::string& value)
+  {
+    check::throw_if_false(process(*this, value, true));
+  }
+
+  // apply: call setters and callbacks, false when parsing into a Result
+  check::checker_ret_t process(State& st, const std::string& value, bool apply) const
+  {
+    st.m_def_unchecked = false;
+    if (m_is_multi)
+    {
+      st.m_str_value = value;
+      push_values(st, value);
+      st.m_is_set = true;
+      return std::make_tuple(true, "");
+    }
+    st.m_str_value = value;
+    st.m_is_set = true;
+    st.clear_values();
+    if (!c_checkers.empty())
+    {
+      if (auto rc = run_checkers(st.m_str_value); !std::get<0>(rc))
+        return rc;
+      st.m_has_valid_value = true;
+    }
+    if (c_loader)
+    {
+      if (auto rc = c_loader(m_raw_name, st.m_str_value, st.m_values); !std::get<0>(rc))
+        return rc;
+    }
+    launch_async(st);
+    if (apply && c_setter)
+    {
+      c_setter(value);
+    }
+    if (apply && c_callback && m_callback_trigger && !st.m_as_default)
+    {
+      c_callback();
+    }
+    return std::make_tuple(true, "");
+  }
+
+  void set(State& st) const
+  {
+    st.m_is_set = true;
+    st.m_str_value = FLAG_VALUE;
+  }
+
+  // call setters and callback with the current value, a bound vector is cleared
+  // first and an unset flag gets its reset value
+  void apply(const State& st) const
+  {
+    if (c_setter)
+    {
+      if (m_is_multi)
+      {
+        if (c_clear)
+          c_clear();
+        for (auto& v : st.m_str_values)
+          c_setter(v);
+      }
+      else
+        c_setter(st.m_str_value);
+    }
+    if (!st.m_is_set)
+      return;
+    if (c_callback && m_callback_trigger && !st.m_as_default)
+      c_callback();
+  }
+
+  bool provide_def(State& st) const
+  {
+    if (st.m_is_set || !c_def_provider)
+      return false;
+    if (auto value = c_def_provider(); value)
+    {
+      st.m_str_value = *value;
+      return true;
+    }
+    return false;
+  }
+
+  // static defaults are not checked here, but once per process and on first access,
+  // see check_default
+  check::checker_ret_t process_def(State& st, bool apply, bool provided) const
+  {
+    st.m_as_default = true;
+    if (provided || c_loader || c_checkers.empty())
+      return process(st, st.m_str_value, apply);
+
+    st.m_str_value = m_default;
+    st.m_is_set = true;
+    st.m_def_unchecked = true;
+    launch_async(st);
+    if (apply && c_setter)
+    {
+      if (auto& rc = check_default(); !std::get<0>(rc))
+        return rc;
+      c_setter(m_default);
+    }
+    return std::make_tuple(true, "");
+  }
+
+  const check::checker_ret_t& check_default() const
+  {
+    std::call_once(m_def_check->once, [this]() {
+      m_def_check->rc = run_checkers(m_default);
+    });
+    return m_def_check->rc;
+  }
+
+  check::checker_ret_t run_checkers(const std::string& value) const
+  {
+    switch (m_check_mode)
+    {
+    case CheckerMode::OR: return check::eval_any(c_checkers, m_raw_name, value);
+    case CheckerMode::XOR: return check::eval_one(c_checkers, m_raw_name, value);
+    default: return check::eval_all(c_checkers, m_raw_name, value);
+    }
+  }
+
+  // run checkers deferred by process_def and checker_async, if any
+  void check_value(const State& st) const
+  {
+    if (st.m_def_unchecked)
+      check::throw_if_false(check_default());
+    check::throw_if_false(wait_async(st));
+  }
+
+  void launch_async(State& st) const
+  {
+    if (c_async_checkers->empty())
+      return;
+    std::vector<std::string> values = m_is_multi ? st.m_str_values
+                                                 : std::vector<std::string>{st.m_str_value};
+    st.m_async = utils::TaskPool::get().submit(
+      [checkers = c_async_checkers, name = m_raw_name, values = std::move(values),
+       until = check::parse_deadline()]() {
+        check::Deadline deadline(until);
+        for (auto& v : values)
+          for (auto& cc : *checkers)
+            if (auto rc = cc(name, v); !std::get<0>(rc))
+              return rc;
+        return check::checker_ret_t{true, ""};
+      }).share();
+  }
+
+  check::checker_ret_t wait_async(const State& st) const
+  {
+    if (!st.m_async.valid())
+      return std::make_tuple(true, "");
+    return st.m_async.get();
+  }
+
+  check::checker_ret_t process_multi(State& st, bool apply) const
+  {
+    if (!st.m_is_set)
+    {
+      st.m_as_default = true;
+      if (!st.m_str_value.empty())
+        push_values(st, st.m_str_value);
+    }
+
+    if (!c_checkers.empty())
+    {
+      std::vector<std::string> errors(st.m_str_values.size());
+      auto until = check::parse_deadline();
+      utils::parallel_for(st.m_str_values.size(), m_nb_threads, [&](size_t i) {
+        if (i < st.m_checked.size() && st.m_checked[i])
+          return;
+        check::Deadline deadline(until);
+        if (auto [res, msg] = run_checkers(st.m_str_values[i]); !res)
+          errors[i] = msg;
+      });
+      std::vector<std::string> failed;
+      for (auto& e : errors)
+        if (!e.empty())
+          failed.push_back(e);
+      if (!failed.empty())
+        return std::make_tuple(false, utils::join(failed, "\n"));
+      st.m_has_valid_value = true;
+    }
+
+    st.clear_values();
+    if (c_typed)
+    {
+      if (auto rc = c_typed(m_raw_name, st.m_str_values, st.m_values); !std::get<0>(rc))
+        return rc;
+    }
+    launch_async(st);
+
+    if (apply && c_setter)
+      for (auto& v : st.m_str_values)
+        c_setter(v);
+    if (apply && c_callback && m_callback_trigger && !st.m_as_default)
+      c_callback();
+    return std::make_tuple(true, "");
+  }
+
+  void reset()
+  {
+    State::reset(m_default);
+  }
+
+PRIVATE:
+  std::string m_raw_name  {};
+  std::string m_help      {};
+  std::string m_default   {};
+  std::string m_short     {};
+  std::string m_long      {};
+  std::string m_meta      {conf::get().m_default_meta};
+
+  Action m_action {Action::Nothing};
+
+  std::vector<std::tuple<checker_fn_t, param_t, checker_fn_t>> m_depends_on {};
+  std::vector<std::tuple<checker_fn_t, param_t, checker_fn_t>> m_banned {};
+  std::vector<std::tuple<Rel, param_t>> m_relations {};
+
+  bool m_has_default     {false};
+  bool m_has_pname       {false};
+  bool m_is_flag         {false};
+  bool m_hidden          {false};
+
+  uint32_t m_id {handle_t::npos};
+
+  bool   m_is_multi  {false};
+  char   m_sep       {','};
+  size_t m_size_hint {0};
+  size_t m_nb_threads {1};
+  bool   m_expand {false};
+  size_t m_expand_threads {0};
+  CheckerMode m_check_mode {CheckerMode::AND};
+
+PRIVATE:
+  setter_fn_t      c_setter;
+  callback_fn_t    c_clear;
+  std::vector<check::Checker> c_checkers;
+  std::shared_ptr<const std::vector<check::Checker>> c_async_checkers {
+    std::make_shared<const std::vector<check::Checker>>()};
+  callback_fn_t    c_callback;
+  provider_fn_t    c_def_provider;
+  std::function<check::checker_ret_t(const std::string&,
+                                     const std::vector<std::string>&, std::any&)> c_typed;
+  std::function<check::checker_ret_t(const std::string&, const std::string&, std::any&)> c_loader;
+
+  bool m_callback_trigger {false};
+
+  std::shared_ptr<DefaultCheck> m_def_check {std::make_shared<DefaultCheck>()};
+};
+
+/**
+ * @ingroup Param
+ * @brief make a std::shared_ptr<Param>
+ *
+ * @param name parameter name -> "-p" || "--param" || "-p/--param"
+ * @param help parameter help
+ * @param setter a setter function
+ * @param checker a checker function
+ * @return param_t std::shared_ptr<Param>
+ */
+inline param_t make(const std::string& name,
+                    const std::string& help,
+                    setter_fn_t setter = nullptr,
+                    checker_fn_t checker = nullptr)
+{
+  return std::make_shared<Param>(Param(name, help, setter, checker));
+}
+
+template<>
+inline param_t Param::setter<setter_fn_t>(setter_fn_t& setter_callback)
+{
+  c_setter = setter_callback;
+  return shared_from_this();
+}
+
+/**
+ * @defgroup ParamGroup
+ * @brief About bcli parameter groups
+ */
+
+class ParamGroup;
+
+/**
+ * @ingroup ParamGroup
+ * @typedef pgroup_t
+ * @brief pgroup_t
+ *
+ * ParamGroup constructor is private, ParamGroup is always used as std::shared_ptr<ParamGroup>
+ */
+using pgroup_t = std::shared_ptr<ParamGroup>;
+
+/**
+ * @ingroup ParamGroup
+ * @brief ParamGroup
+ *
+ * ParamGroup class
+ */
+class ParamGroup
+{
+  friend pgroup_t make_group(const std::string& name,
+                             const std::string& desc);
+  friend class Command;
+  friend class Parser<0>;
+  friend class Parser<1>;
+
+PRIVATE:
+  ParamGroup(const std::string& name,
+             const std::string& desc)
+    : m_name(name), m_desc(desc)
+  {}
+
+  std::string get_help()
+  {
+    if (m_hidden)
+      return "";
+
+    std::stringstream help;
+    const std::string& fsymb = conf::get().m_flag_symbol;
+    help.fill(' ');
+    help << utils::sp(2) << utils::wrap(m_name, "[]");
+    if (!m_desc.empty()) help << " - " << m_desc;
+    help << "\n";
+    auto [maxs, maxl] = padding();
+    for (auto& p : m_order)
+    {
+      if (p->hidden())
+        continue;
+      std::string fl = p->is_flag() ? " " + fsymb : "";
+      help << utils::sp(4);
+      if (!p->sp().empty())
+        help << std::setw(maxs) << std::right << p->sp();
+      else help << utils::sp(maxs);
+      help << " ";
+      if (!p->lp().empty())
+        help << std::setw(maxl) << std::left << p->lp();
+      else help << utils::sp(maxl-fl.size());
+
+      help <<" - " << p->get_help() << " ";
+
+      if (p->is_flag()) help << utils::wrap(fsymb, "[]");
+      if (!p->get_def().empty()) help << utils::wrap(p->get_def(), "{}");
+      help << "\n";
+    }
+    help << "\n";
+    return help.str();
+  }
+
+public:
+  /**
+   * @brief add param
+   *
+   * @param name param name (ex: "-p/--param")
+   * @param help parma help
+   * @return param_t
+   */
+  param_t add_param(const std::string& name,
+                    const std::string& help)
+  {
+    param_t p = make(name, help);
+    add(p);
+    return p;
+  }
+
+  /**
+   * @brief get param_t
+   *
+   * @param pname param name
+   * @return param_t
+   */
+  param_t get(const std::string& pname)
+  {
+    if (m_params.count(pname) > 0)
+      return m_params.at(pname);
+    else
+      BCLI_THROW(ex::UnknownParamError(pname + "doesn't exist in group " + m_name));
+  }
+
+  auto begin() { return m_order.begin(); }
+  auto end() { return m_order.end(); }
+  auto begin() const { return m_order.begin(); }
+  auto end() const { return m_order.end(); }
+
+  void hide()
+  {
+    m_hidden = true;
+  }
+
+  bool hidden()
+  {
+    return m_hidden;
+  }
+
+PRIVATE:
+  bool exists(const std::string& pname)
+  {
+    std::string p = utils::trim_param(pname);
+    return m_params.count(p) > 0;
+  }
+
+  const std::string& name()
+  {
+    return m_name;
+  }
+
+  bool empty()
+  {
+    return m_order.size() == 0;
+  }
+
+  void add(param_t p)
+  {
+    auto [sp, lp] = p->idx();
+    already_exists(p, sp, lp);
+    if (!sp.empty()) m_params.insert({sp, p});
+    if (!lp.empty()) m_params.insert({lp, p});
+    m_nbp++;
+    m_order.push_back(p);
+  }
+
+  std::tuple<int, int> padding()
+  {
+    size_t max_s = 0, max_l = 0;
+    for (auto& p: m_order)
+    {
+      max_s = p->sp().size() < max_s ? max_s : p->sp().size();
+      max_l = p->lp().size() < max_l ? max_l : p->lp().size();
+    }
+    return std::make_tuple(max_s, max_l);
+  }
+
+  void already_exists(param_t p, const std::string& sp, const std::string& lp)
+  {
+    if (m_params.count(sp) > 0 || m_params.count(lp) > 0)
+    {
+      ex::ExHandler::get().push(
+        ex::AlreadyExistsError(p->raw() + " already exists in group " + m_name));
+    }
+  }
+
+PRIVATE:
+  std::string                              m_name {};
+  std::string                              m_desc {};
+  std::unordered_map<std::string, param_t> m_params {};
+  std::vector<param_t>                     m_order {};
+  size_t                                   m_nbp {0};
+  bool                                     m_hidden {false};
+};
+
+/**
+ * @ingroup ParamGroup
+ * @brief make a std::shared_ptr<ParamGroup>
+ *
+ * @param name group name
+ * @param desc group description
+ * @return pgroup_t
+ */
+inline pgroup_t make_group(const std::string& name,
+                           const std::string& desc)
+{
+  return std::make_shared<ParamGroup>(ParamGroup(name, desc));
+}
+
+/**
+ * @ingroup Param
+ * @brief Constraints
+ *
+ * Cross-parameter constraints of a command (depends_on, banned, mutually exclusive
+ * and at-least-one groups, relations), compiled once by Parser::freeze.
+ * At each parse, set parameters are gathered in bitsets, then each rule is evaluated
+ * once, and all violations are reported. Rules are also indexed by param, to
+ * revalidate only the rules reachable from an updated param (see Parser::update).
+ */
+class Constraints
+{
+public:
+  enum class Kind
+  {
+    Depends,
+    Banned,
+    Exclusive,
+    AtLeastOne,
+    Relation
+  };
+
+  struct Rule
+  {
+    Kind                kind;
+    Param*              p {nullptr};
+    Param*              d {nullptr};
+    const checker_fn_t* when {nullptr};
+    const checker_fn_t* then {nullptr};
+    Rel                 rel {Rel::Eq};
+    std::vector<Param*> group {};
+    utils::Bitset       mask {};
+  };
+
+  /**
+   * @brief compile rules, param ids must be assigned
+   *
+   * @param order command groups
+   * @param exclusive mutually exclusive groups
+   * @param at_least_one at-least-one groups
+   * @param nb_params number of indexed params
+   */
+  void compile(const std::vector<pgroup_t>& order,
+               const std::vector<std::vector<param_t>>& exclusive,
+               const std::vector<std::vector<param_t>>& at_least_one,
+               size_t nb_params)
+  {
+    m_rules.clear();
+    m_params.clear();
+    m_nb_params = nb_params;
+    m_adjacency.assign(nb_params, {});
+
+    for (auto& group : order)
+    {
+      for (auto& p : *group)
+      {
+        for (auto& [c, d, dc] : p->m_depends_on)
+          add({Kind::Depends, p.get(), d.get(), &c, dc ? &dc : nullptr});
+        for (auto& [c, d, dc] : p->m_banned)
+          add({Kind::Banned, p.get(), d.get(), &c, dc ? &dc : nullptr});
+        for (auto& [rel, d] : p->m_relations)
+          add({Kind::Relation, p.get(), d.get(), nullptr, nullptr, rel});
+      }
+    }
+
+    auto add_group = [this](Kind kind, const std::vector<param_t>& params) {
+      Rule rule {kind};
+      rule.mask = utils::Bitset(m_nb_params);
+      for (auto& p : params)
+      {
+        if (p->id() >= m_nb_params)
+          continue;
+        rule.group.push_back(p.get());
+        rule.mask.set(p->id());
+      }
+      add(std::move(rule));
+    };
+    for (auto& g : exclusive)
+      add_group(Kind::Exclusive, g);
+    for (auto& g : at_least_one)
+      add_group(Kind::AtLeastOne, g);
+  }
+
+  /**
+   * @brief evaluate all rules, or only the rules involving a param
+   *
+   * @param state State&(Param&), per-parse state of a param
+   * @param fail void(Kind, std::string), called on each violation
+   * @param only if not null, only rules involving this param are evaluated
+   */
+  template<typename StateFn, typename FailFn>
+  void eval(StateFn&& state, FailFn&& fail, const Param* only = nullptr) const
+  {
+    if (only && only->id() >= m_adjacency.size())
+      return;
+
+    utils::Bitset is_set, by_user;
+    bool has_bits = false;
+    auto bits = [&]() {
+      if (has_bits)
+        return;
+      is_set = utils::Bitset(m_nb_params);
+      by_user = utils::Bitset(m_nb_params);
+      for (Param* p : m_params)
+      {
+        const State& st = state(*p);
+        if (st.m_is_set)
+        {
+          is_set.set(p->id());
+          if (!st.m_as_default)
+            by_user.set(p->id());
+        }
+      }
+      has_bits = true;
+    };
+
+    size_t n = only ? m_adjacency[only->id()].size() : m_rules.size();
+    for (size_t i=0; i<n; i++)
+    {
+      const Rule& r = only ? m_rules[m_adjacency[only->id()][i]] : m_rules[i];
+      switch (r.kind)
+      {
+      case Kind::Depends:
+      case Kind::Banned:
+      {
+        const State& ps = state(*r.p);
+        auto [res, msg] = (*r.when)(r.p->raw(), ps.m_str_value);
+        if (!res)
+          break;
+        const State& ds = state(*r.d);
+        bool violated = r.kind == Kind::Depends ? !ds.m_is_set : ds.m_is_set;
+        if (r.then)
+        {
+          auto [dres, dmsg] = (*r.then)(r.d->raw(), ds.m_str_value);
+          violated = r.kind == Kind::Depends ? !dres : dres;
+          msg = dmsg;
+        }
+        if (!violated)
+          break;
+        if (r.kind == Kind::Depends)
+          fail(r.kind, utils::format_depend_errors(r.p->raw(), ps.m_str_value, r.d->raw(), msg));
+        else
+          fail(r.kind, utils::format_banned_errors(
+            r.p->raw(), ps.m_str_value, r.d->raw(), ds.m_str_value, msg));
+        break;
+      }
+      case Kind::Exclusive:
+      {
+        bits();
+        if (by_user.count_and(r.mask) > 1)
+          fail(r.kind, group_names(r, &by_user) + " are mutually exclusive.");
+        break;
+      }
+      case Kind::AtLeastOne:
+      {
+        bits();
+        if (is_set.count_and(r.mask) == 0)
+          fail(r.kind, "at least one of " + group_names(r, nullptr) + " is required.");
+        break;
+      }
+      case Kind::Relation:
+      {
+        const State& ps = state(*r.p);
+        const State& ds = state(*r.d);
+        if (!ps.m_is_set || !ds.m_is_set)
+          break;
+        double a, b;
+        if (!utils::try_from_string(ps.m_str_value, a) || !utils::try_from_string(ds.m_str_value, b))
+          break;
+        if (!holds(r.rel, a, b))
+          fail(r.kind, r.p->raw() + " " + ps.m_str_value + " must be " + symbol(r.rel) + " "
+                       + r.d->raw() + " " + ds.m_str_value + ".");
+        break;
+      }
+      }
+    }
+  }
+
+  bool empty() const
+  {
+    return m_rules.empty();
+  }
+
+PRIVATE:
+  void add(Rule&& rule)
+  {
+    uint32_t index = static_cast<uint32_t>(m_rules.size());
+    std::vector<Param*> involved = rule.group;
+    involved.push_back(rule.p);
+    involved.push_back(rule.d);
+    std::sort(involved.begin(), involved.end());
+    involved.erase(std::unique(involved.begin(), involved.end()), involved.end());
+    for (Param* p : involved)
+      if (p && p->id() < m_nb_params)
+        m_adjacency[p->id()].push_back(index);
+
+    for (Param* p : rule.group)
+      m_params.push_back(p);
+    std::sort(m_params.begin(), m_params.end());
+    m_params.erase(std::unique(m_params.begin(), m_params.end()), m_params.end());
+    m_rules.push_back(std::move(rule));
+  }
+
+  static std::string group_names(const Rule& r, const utils::Bitset* filter)
+  {
+    std::vector<std::string> names;
+    for (Param* p : r.group)
+      if (!filter || filter->test(p->id()))
+        names.push_back(p->raw());
+    return utils::wrap(utils::join(names, filter ? ", " : "|"), "[]");
+  }
+
+  static bool holds(Rel rel, double a, double b)
+  {
+    switch (rel)
+    {
+    case Rel::Lt: return a < b;
+    case Rel::Le: return a <= b;
+    case Rel::Gt: return a > b;
+    case Rel::Ge: return a >= b;
+    case Rel::Eq: return a == b;
+    case Rel::Ne: return a != b;
+    }
+    return true;
+  }
+
+  static std::string symbol(Rel rel)
+  {
+    switch (rel)
+    {
+    case Rel::Lt: return "<";
+    case Rel::Le: return "<=";
+    case Rel::Gt: return ">";
+    case Rel::Ge: return ">=";
+    case Rel::Eq: return "==";
+    case Rel::Ne: return "!=";
+    }
+    return {};
+  }
+
+PRIVATE:
+  std::vector<Rule>   m_rules {};
+  std::vector<Param*> m_params {};
+  size_t              m_nb_params {0};
+
+  std::vector<std::vector<uint32_t>> m_adjacency {};
+};
+
+/**
+ * @defgroup Command
+ * @brief About bcli commands
+ */
+
+class Command;
+
+/**
+ * @ingroup Command
+ * @typedef cmd_t
+ * @brief Command constuctor is private, Command is always used as std::shared_ptr<Command>
+ *
+ */
+using cmd_t = std::shared_ptr<Command>;
+
+class Commands;
+/**
+ * @ingroup Command
+ * @brief Command
+ *
+ * Command class
+ */
+class Command
+{
+  friend cmd_t make_cmd(const std::string& name,
+                        const std::string& desc,
+                        help_fn_t help);
+
+  friend class Parser<0>;
+  friend class Parser<1>;
+  friend class Commands;
+
+PRIVATE:
+  Command(const std::string& name,
+          const std::string& desc,
+          help_fn_t help = nullptr)
+    : m_name(name), m_desc(desc), m_help(help)
+  {}
+
+public:
+  /**
+   * @brief set command help
+   *
+   * @param help
+   */
+  void set_help(help_fn_t help)
+  {
+    m_help = help;
+  }
+
+  /**
+   * @brief add param to current group
+   *
+   * @param name parameter name (ex: "-p/--param")
+   * @param help  parameter help
+   * @return param_t
+   */
+  param_t add_param(const std::string& name,
+                   const std::string& help)
+  {
+    return m_current_group->add_param(name, help);
+  }
+
+  /**
+   * @brief add group to command
+   *
+   * @param name group name
+   * @param desc group description
+   * @return pgroup_t
+   */
+  pgroup_t add_group(const std::string& name,
+                     const std::string& desc)
+  {
+    param::pgroup_t group = make_group(name, desc);
+    add(group);
+    return group;
+  }
+
+  /**
+   * @brief add a group with common parameters
+   *
+   * "-h/--help" -> trigger help \n
+   * "-v/--verbose" -> trigger version \n
+   * "-d/--debug" \n
+   * "--version" \n
+   * @see bc::Action
+   * @see Configuration
+   *
+   * @param name group name
+   * @return pgroup_t
+   */
+  pgroup_t add_common(const std::string& name = "common")
+  {
+    if (conf::get().has_common())
+    {
+      pgroup_t grp = add_group(name, {});
+      if (conf::get().m_help)
+        grp->add_param("-h/--help", "Show this message and exit.")
+           ->as_flag()->action(Action::ShowHelp);
+      if (conf::get().m_verbose)
+        grp->add_param("-v/--verbose", "Verbose mode.")->as_flag();
+      if (conf::get().m_debug)
+        grp->add_param("-d/--debug", "Debug mode.")->as_flag();
+      if (conf::get().m_version)
+       grp->add_param("--version", "Show version and exit.")
+           ->as_flag()->action(Action::ShowVersion);
+      return grp;
+    }
+    else
+      return nullptr;
+  }
+
+  /**
+   * @brief get parameter
+   *
+   * @code
+   * cmd->add_param("-p/--param", "help param");
+   *
+   * cmd->getp("p");
+   * cmd->getp("param");
+   * cmd->getp("-p");
+   * cmd->getp("--param");
+   *
+   * @endcode
+   * @param name
+   * @return param_t
+   */
+  param_t getp(const std::string& name)
+  {
+    std::string name_ = utils::trim_param(name);
+    for (auto& grp : m_order)
+      if (grp->exists(name_))
+        return grp->get(name_);
+    return nullptr;
+  }
+
+  /**
+   * @brief get positional parameters
+   *
+   * @return const utils::FrontCodedStore&
+   */
+  const utils::FrontCodedStore& get_positionals() const
+  {
+    return m_positionals;
+  }
+
+  /**
+   * @brief set positionals help
+   *
+   * @param usage
+   * @param help
+   */
+  void set_positionals_help(const std::string& usage, const std::string& help)
+  {
+    m_usage_pos = usage;
+    m_help_pos = help;
+  }
+
+  /**
+   * @brief set number of positionals
+   *
+   * @param nb number of positionals
+   * @param usage
+   * @param help
+   */
+  void set_positionals(size_t nb,
+                       const std::string& usage,
+                       const std::string& help)
+  {
+    m_e_pos = nb;
+    m_usage_pos = usage;
+    m_help_pos = help;
+    m_checkp = true;
+  }
+
+  /**
+   * @brief set positionals bounds
+   *
+   * @param min min number of positionals
+   * @param max max number of positionals
+   * @param usage
+   * @param help
+   */
+  void set_positional_bounds(size_t min, size_t max,
+                             const std::string& usage,
+                             const std::string& help)
+  {
+    m_l_pos = min;
+    m_u_pos = max;
+    m_usage_pos = usage;
+    m_help_pos = help;
+    m_checkp = true;
+    m_bmode = true;
+  }
+
+  /**
+   * @brief set checker for positionals
+   *
+   * @param checker
+   */
+  void positionals_checker(checker_fn_t checker)
+  {
+    c_pchecker = checker;
+  }
+
+  /**
+   * @brief run the positionals checker in parallel
+   *
+   * Useful for file checkers on many positionals. The checker must be thread-safe.
+   *
+   * @param nb_threads number of threads, 0 -> std::thread::hardware_concurrency()
+   */
+  void parallel_positional_checks(size_t nb_threads = 0)
+  {
+    m_nb_threads = nb_threads == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1)
+                                   : nb_threads;
+  }
+
+  /**
+   * @brief expand positionals which are globs or directories into files
+   *
+   * Files are kept if they pass the positionals checker, see utils::expand_path.
+   *
+   * @param nb_threads number of threads of the directory walker, 0 -> all
+   */
+  void expand_positionals(size_t nb_threads = 0)
+  {
+    m_expand = true;
+    m_expand_threads = nb_threads;
+  }
+
+  /**
+   * @brief detect input files given twice, under any name
+   *
+   * Positionals and the values of the given multi-value params are compared by
+   * utils::FileId, which catches hardlinks and symlinks. The positionals setter has
+   * already seen dropped positionals.
+   *
+   * @param policy Dedup::Drop keeps the first occurrence, Dedup::Error raises
+   *               a DuplicateInputError
+   * @param params multi-value params holding input files
+   */
+  void dedup_inputs(Dedup policy, const std::vector<param_t>& params = {})
+  {
+    m_dedup = policy;
+    m_dedup_params = params;
+  }
+
+  void positionals_setter(setter_fn_t setter)
+  {
+    c_psetter = setter;
+  }
+
+  /**
+   * @brief read positionals from a stream, one per line, when "-" or
+   *        "--inputs-from-stdin" is given
+   *
+   * Each line is pushed (and given to the positionals setter) as soon as it is read,
+   * the positionals bounds are checked at the end.
+   *
+   * @param in
+   */
+  void positionals_from(std::istream& in = std::cin)
+  {
+    m_pos_stream = &in;
+  }
+
+  /**
+   * @brief set a group of mutually exclusive params, at most one can be used
+   *
+   * Params set by default are not taken into account.
+   *
+   * @param params
+   */
+  void mutually_exclusive(const std::vector<param_t>& params)
+  {
+    m_exclusive.push_back(params);
+  }
+
+  /**
+   * @brief set a group of params, at least one must have a value
+   *
+   * @param params
+   */
+  void at_least_one(const std::vector<param_t>& params)
+  {
+    m_at_least_one.push_back(params);
+  }
+
+  auto begin() { return m_order.begin(); }
+  auto end() { return m_order.end(); }
+  auto begin() const { return m_order.begin(); }
+  auto end() const { return m_order.end(); }
+
+PRIVATE:
+  std::string& name()
+  {
+    return m_name;
+  }
+
+  std::string& desc()
+  {
+    return m_desc;
+  }
+
+  utils::NameIndex names()
+  {
+    utils::NameIndex index;
+    for (auto& g : m_order)
+      for (auto& p : *g)
+      {
+        index.add(p->sp());
+        index.add(p->lp());
+      }
+    index.freeze();
+    return index;
+  }
+
+  // cheap fingerprint of the schema, a param, group or rule added since the last
+  // freeze changes it
+  size_t schema_size() const
+  {
+    size_t n = m_order.size() + m_exclusive.size() + m_at_least_one.size();
+    for (auto& g : m_order)
+      for (auto& p : *g)
+        n += 1 + p->m_depends_on.size() + p->m_banned.size() + p->m_relations.size();
+    return n;
+  }
+
+  utils::RadixTrie long_names()
+  {
+    utils::RadixTrie trie;
+    for (auto& g : m_order)
+      for (auto& p : *g)
+        if (!p->lp().empty())
+          trie.insert(p->lp().substr(2));
+    trie.freeze();
+    return trie;
+  }
+
+  std::string get_help(const std::string& main_name, const std::string& version, bool cmd_mode)
+  {
+    if (m_help)
+      return m_help();
+    else
+    {
+      std::stringstream ss;
+      ss << main_name << " ";
+      if (cmd_mode) ss << m_name << " ";
+      ss << version << "\n\n";
+
+      ss << "DESCRIPTION" << "\n" << utils::sp(2);
+      ss << m_desc << "\n\n";
+
+      ss << "USAGE" << "\n" << utils::sp(2);
+      if (cmd_mode) ss << main_name << " ";
+      ss << m_name << " " << get_usage(main_name, cmd_mode) << "\n\n";
+      if (!m_help_pos.empty())
+      {
+        ss << "POSITIONALS" << "\n";
+        ss << utils::sp(2) << m_help_pos << "\n\n";
+      }
+      ss << "OPTIONS" << "\n";
+      for (auto& g : m_order)
+        if (!g->empty())
+          ss << g->get_help();
+      return ss.str();
+    }
+  }
+
+  std::string get_usage(const std::string& main_name, bool cmd_mode)
+  {
+    std::stringstream ss;
+    std::vector<std::string> required;
+    std::vector<std::string> optionals;
+    std::vector<std::string> flags;
+
+    for (auto& group : m_order)
+    {
+      if (group->hidden())
+        continue;
+      for (auto& p : *group)
+      {
+        if (p->hidden())
+          continue;
+        std::string bds = p->is_required() ? "" : "[]";
+        std::string raw;
+        if (p->is_flag())
+          raw = p->raw();
+        else
+          raw = p->raw() + " " + utils::wrap(p->get_meta() + (p->is_multi() ? "..." : ""), "<>");
+        std::string fm = utils::wrap(raw, bds);
+
+        if (p->is_required())
+          required.push_back(fm);
+        else if (p->is_flag())
+          flags.push_back(fm);
+        else
+          optionals.push_back(fm);
+      }
+    }
+
+    size_t pad;
+    if (cmd_mode) pad = main_name.size() + 1 + m_name.size();
+    else pad = m_name.size();
+
+    auto format = [&ss, &pad](const std::vector<std::string> vec, int c) -> int {
+      size_t max_size = 90;
+      int current = c;
+      for (auto& f : vec)
+      {
+        if (current + f.size() < max_size)
+        {
+          ss << f << " ";
+          current += f.size();
+        }
+        else
+        {
+          ss << "\n" << utils::sp(pad+3) << f << " ";
+          current = f.size()+pad+3;
+        }
+      }
+      return current;
+    };
+    format(flags, format(optionals, format(required, 0)));
+    ss << m_usage_pos;
+    return ss.str();
+  }
+
+  std::tuple<bool, std::string> check_positionals() const
+  {
+    return check_positionals(m_positionals);
+  }
+
+  // checked: positionals already checked by an expansion, empty if none
+  std::tuple<bool, std::string> check_positionals(const utils::FrontCodedStore& positionals,
+                                                  const std::vector<uint8_t>& checked = {}) const
+  {
+    if (m_checkp)
+    {
+      if (m_bmode)
+      {
+        if (positionals.size() < m_l_pos)
+          return std::make_tuple(
+            false,
+            "requires at least " + std::to_string(m_l_pos) + " positionals.");
+        else if (positionals.size() > m_u_pos)
+          return std::make_tuple(
+            false,
+            "requires at most " + std::to_string(m_u_pos) + " positionals.");
+      }
+      else if (positionals.size() != m_e_pos)
+        return std::make_tuple(
+          false,
+          "number of positionals must be " + std::to_string(m_e_pos)
+        );
+    }
+
+    if (c_pchecker)
+    {
+      // checks share one label, failures are rare and get their index afterwards
+      static const std::string label = "positionals";
+      std::mutex mutex;
+      std::vector<std::pair<size_t, std::string>> failed;
+      auto until = check::parse_deadline();
+      utils::parallel_for(positionals.size(), m_nb_threads, [&](size_t i) {
+        if (i < checked.size() && checked[i])
+          return;
+        check::Deadline deadline(until);
+        thread_local std::string buffer;
+        positionals.get(i, buffer);
+        if (auto [res, msg] = c_pchecker(label, buffer); !res)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          failed.emplace_back(i, std::move(msg));
+        }
+      }, 256);
+
+      std::sort(failed.begin(), failed.end());
+      std::vector<std::string> errors;
+      for (auto& [i, msg] : failed)
+      {
+        std::string indexed = label + "[" + std::to_string(i) + "]";
+        if (size_t pos = msg.find(label); pos != std::string::npos)
+          msg.replace(pos, label.size(), indexed);
+        else
+          msg.insert(0, indexed + ": ");
+        errors.push_back(std::move(msg));
+      }
+      if (!errors.empty())
+        return std::make_tuple(false, utils::join(errors, "\n"));
+    }
+
+    return std::make_tuple(true, "");
+  }
+
+  void reset()
+  {
+    m_positionals.clear();
+    m_nb_pos = 0;
+  }
+
+  void push_positionals(const std::string& arg)
+  {
+    m_positionals.push_back(arg);
+    m_nb_pos++;
+    if (c_psetter)
+      c_psetter(arg);
+  }
+
+  // call push(path, checked) on arg, or on each file it expands to, checked is true
+  // for files that passed the positionals checker while expanding
+  template<typename Push>
+  void expand_positional(const std::string& arg, Push&& push) const
+  {
+    std::error_code ec;
+    if (!m_expand || (!utils::is_glob(arg) && !fs::is_directory(arg, ec)))
+    {
+      push(arg, false);
+      return;
+    }
+    auto until = check::parse_deadline();
+    auto files = utils::expand_path(arg, m_expand_threads, [this, until](const std::string& f) {
+      check::Deadline deadline(until);
+      return !c_pchecker || std::get<0>(c_pchecker("positionals", f));
+    });
+    bool checked = files.size() != 1 || files[0] != arg;
+    for (auto& file : files)
+      push(file, checked);
+  }
+
+  void add(pgroup_t pg)
+  {
+    if (m_groups.count(pg->name()) > 0)
+    {
+      ex::ExHandler::get().push(
+        ex::AlreadyExistsError(pg->name() + "group already exists in command " + m_name));
+    }
+    else
+    {
+      m_groups.insert({pg->name(), pg});
+      m_order.push_back(pg);
+      m_current_group = pg;
+    }
+  }
+
+  pgroup_t get(const std::string& name)
+  {
+    if (m_groups.count(name) == 0)
+      BCLI_THROW(ex::UnknownGroupError(name + "doesn't exist in command " + m_name));
+    else
+      return m_groups.at(name);
+  }
+
+PRIVATE:
+  std::string m_name {};
+  std::string m_desc {};
+  help_fn_t   m_help {nullptr};
+  pgroup_t    m_def_group {make_group("", "")};
+  pgroup_t    m_current_group {};
+  bool        m_def_use {false};
+  size_t      m_nb_pos {0};
+  std::unordered_map<std::string, pgroup_t> m_groups;
+  std::vector<pgroup_t>                     m_order;
+  utils::FrontCodedStore m_positionals;
+
+  std::string m_help_pos {};
+  std::string m_usage_pos {};
+  size_t m_e_pos {0};
+  size_t m_l_pos {0};
+  size_t m_u_pos {0};
+  bool   m_checkp {false};
+  bool   m_bmode {false};
+
+  checker_fn_t c_pchecker {nullptr};
+  setter_fn_t  c_psetter {nullptr};
+  std::istream* m_pos_stream {nullptr};
+  size_t       m_nb_threads {1};
+  bool         m_expand {false};
+  size_t       m_expand_threads {0};
+  std::optional<Dedup> m_dedup {};
+  std::vector<param_t> m_dedup_params {};
+
+  std::vector<std::vector<param_t>> m_exclusive {};
+  std::vector<std::vector<param_t>> m_at_least_one {};
+  Constraints m_constraints {};
+  utils::NameIndex m_names {};
+  utils::RadixTrie m_long_names {};
+  std::unordered_map<std::string_view, Param*> m_lookup {};
+};
+
+/**
+ * @ingroup Command
+ * @brief make a std::shared_ptr<Command>
+ *
+ * @param name command name
+ * @param desc command description
+ * @param help command help
+ * @return cmd_t
+ */
+inline cmd_t make_cmd(const std::string& name,
+                      const std::string& desc,
+                      help_fn_t help = nullptr)
+{
+  return std::make_shared<Command>(Command(name, desc, help));
+}
+
+class Commands;
+/**
+ * @ingroup Command
+ * @typedef cmds_t
+ * @brief Commands constuctor is private, Commands is always used as std::shared_ptr<Commands>
+ *
+ */
+using cmds_t = std::unique_ptr<Commands>;
+
+class Commands
+{
+  friend cmds_t make_cmds(const std::string&, const std::string&, const std::string&);
+  friend class Parser<1>;
+  friend class Parser<0>;
+
+PRIVATE:
+  Commands(const std::string& name, const std::string& desc, const std::string& version)
+    : m_name(name), m_desc(desc), m_version(version)
+  {}
 
-/**
- * @ingroup Checkers
- * @brief bz2 checker
- *
- */
-inline auto is_bz2 = f::check_magic<3>("bz2", {0x42, 0x5A, 0x68});
+  void set_help(help_fn_t help)
+  {
+    m_help = help;
+  }
 
-/**
- * @ingroup Checkers
- * @brief bam checker
- *
- */
-inline auto is_bam = f::check_magic<4>("bam", {0x1F, 0x8B, 0x08, 0x04});
+  cmd_t get(const std::string& name)
+  {
+    return m_cmds.at(name);
+  }
 
-/**
- * @ingroup Checkers
- * @brief cram checker
- *
- */
-inline auto is_cram = f::check_magic<4>("cram", {0x43, 0x52, 0x41, 0x4d});
+  bool exists(const std::string& name)
+  {
+    return m_cmds.count(name) > 0;
+  }
 
-} // end of namespace checker
+  std::vector<std::string> list()
+  {
+    std::vector<std::string> ret;
+    for (auto& c : m_order)
+      ret.push_back(c->name());
+    return ret;
+  }
 
+  utils::NameIndex names()
+  {
+    utils::NameIndex index;
+    for (auto& c : m_order)
+      index.add(c->name());
+    index.freeze();
+    return index;
+  }
 
-/**
- * @defgroup Param
- * @brief About bcli parameters
- */
+  std::string get_help()
+  {
+    if (m_help)
+      return m_help();
+    else
+    {
+      size_t pad = (*std::max_element(m_order.begin(), m_order.end(), [](cmd_t a, cmd_t b) -> bool {
+          return a->name().size() < b->name().size();
+      }))->name().size();
+      std::stringstream help;
+      help << m_name << " " << m_version << "\n\n";
+      help << "DESCRIPTION" << "\n" << utils::sp(2) << m_desc << "\n\n";
+      help << "USAGE" << "\n" << utils::sp(2);
+      help << m_name << " " << utils::wrap(utils::join(list(), "|"), "[]") << "\n\n";
+      help << "COMMANDS" << "\n";
+      for (auto& cmd: m_order)
+      {
+        help << utils::sp(2) << std::setw(pad) << std::left << cmd->name() << " - " << cmd->desc() << "\n";
+      }
+      return help.str();
+    }
+  }
 
-const std::string FLAG_VALUE = "BCLI_FSET";
+  void add(cmd_t c)
+  {
+    m_cmds.insert({c->name(), c});
+    m_order.push_back(c);
+  }
 
-/**
- * @ingroup Param
- * @enum Action
- * @brief parameter actions
- *
- */
-enum Action
-{
-  Nothing,     /*!< Nothing  */
-  ShowHelp,    /*!< Trigger help */
-  ShowVersion  /*!< Trigger version */
+PRIVATE:
+  std::string m_name;
+  std::string m_desc;
+  std::string m_version;
+  std::unordered_map<std::string, cmd_t> m_cmds;
+  std::vector<cmd_t>                     m_order;
+  help_fn_t                              m_help {nullptr};
+  utils::NameIndex                       m_names {};
 };
 
-/**
- * @namespace param
- * @brief bcli param namespace
- *
- *
- */
-namespace param {
+inline cmds_t make_cmds(const std::string& name,
+                        const std::string& desc,
+                        const std::string& version)
+{
+  return std::make_unique<Commands>(Commands(name, desc, version));
+}
 
-class Param;
+} // end of namespace param
 
 /**
- * @ingroup Param
- * @typedef param_t
- * @brief param_t
+ * @defgroup Parser
+ * @brief About bcli parser.
  *
- * Param constuctor is private, Param is always used as std::shared_ptr<Param>
  */
-using param_t = std::shared_ptr<Param>;
+
+using pgroup_t = param::pgroup_t;
+using param_t  = param::param_t;
+using cmd_t    = param::cmd_t;
+using handle_t = param::handle_t;
+using conf     = config::Config;
+
+template<typename T = int>
+using range_list_t = param::RangeList<T>;
 
 /**
- * @ingroup Param
- * @typedef checker_fn_t
- * @brief checker function signature
+ * @ingroup Parser
+ * @brief field_t
  *
+ * Maps a struct member to a parameter, see Parser::bind.
  *
+ * @tparam S struct type
+ * @tparam T member type
  */
-using checker_fn_t = check::checker_fn_t;
+template<typename S, typename T>
+struct field_t
+{
+  T S::* member;
+  const char* name;
 
-/**
- * @ingroup Param
- * @typedef setter_fn_t
- * @brief setter function signature
- *
- */
-using setter_fn_t = std::function<void(const std::string&)>;
+  /**
+   * @brief first name of the param (ex: "-k/--kmer-size" -> "-k")
+   */
+  std::string key() const
+  {
+    std::string_view n(name);
+    return std::string(n.substr(0, n.find('/')));
+  }
+
+  void store(S& s, param::Param& p) const
+  {
+    if constexpr(std::is_same_v<T, bool>)
+      s.*member = p.is_set();
+    else
+    {
+      if (!p.is_set() && p.value().empty())
+        return;
+      if constexpr(utils::is_vector_v<T>)
+        s.*member = p.values<typename T::value_type>();
+      else if constexpr(std::is_arithmetic_v<T> || utils::is_string_v<T>)
+        s.*member = utils::from_string<T>(p.value());
+      else
+        s.*member = p.as<T>();
+    }
+  }
+};
 
 /**
- * @ingroup Param
- * @typedef help_fn_t
- * @brief help function signature
+ * @ingroup Parser
+ * @brief make a field_t
  *
+ * @param member pointer to member (ex: &Options::k)
+ * @param name param name (ex: "-k/--kmer-size")
+ * @return field_t<S, T>
  */
-using help_fn_t = std::function<std::string()>;
+template<typename S, typename T>
+constexpr field_t<S, T> field(T S::* member, const char* name)
+{
+  return {member, name};
+}
 
 /**
- * @ingroup Param
- * @typedef callback_fn_t
- * @brief callback function signature
+ * @ingroup Parser
+ * @brief fields
  *
+ * Field list of a struct, specialize it with BCLI_FIELDS to use Parser::bind<S>().
  */
-using callback_fn_t = std::function<void()>;
-
-using conf = config::Config;
+template<typename S>
+struct fields;
 
 /**
- * @brief get a setter from variable reference
+ * @ingroup Parser
+ * @def BCLI_FIELDS
+ * @brief declare the field list of a struct (at global scope)
  *
- * Returns a setter to set T var
+ * @code
+ * struct Options { int k {31}; std::string mode; bool lz4 {false}; };
  *
- * @tparam T
- * @param var variable to set
- * @return setter_fn_t
+ * BCLI_FIELDS(Options,
+ *   bc::field(&Options::k, "-k/--kmer-size"),
+ *   bc::field(&Options::mode, "-m/--mode"),
+ *   bc::field(&Options::lz4, "--lz4"))
+ * @endcode
  */
-template<typename T>
-setter_fn_t get_setter(T& var)
-{
-  return [&var] (const std::string& in = {}) {
-    if constexpr(std::is_same_v<T, bool>)
-    {
-      if (in == FLAG_VALUE)
-        var = true;
-      else
-        var = false;
-    }
-    else
-    {
-      var = utils::lexical_cast<T>(in);
-    }
-  };
-}
-
-//enum CheckerMode
-//{
-//  AND,
-//  OR,
-//  XOR
-//};
-
-class ParamGroup;
+#define BCLI_FIELDS(S, ...)                                        \
+template<>                                                         \
+struct bc::fields<S>                                               \
+{                                                                  \
+  static constexpr auto value = std::make_tuple(__VA_ARGS__);      \
+};                                                                 \
 
 /**
- * @ingroup Param
- * @brief Param
+ * @ingroup Parser
+ * @brief Result
  *
- * Parameter class
+ * Per-parse results of Parser::parse(argc, argv, result), indexed by handles.
+ * A Result can be reused for several parses, buffers are kept.
  */
-class Param: public std::enable_shared_from_this<Param>
+class Result
 {
-  using s_ptr = std::shared_ptr<Param>;
-  friend param_t make(const std::string& name,
-                      const std::string& help,
-                      setter_fn_t setter,
-                      checker_fn_t checker);
-
-  friend class ParamTest;
-  friend class ParamGroup;
-  friend class Command;
   friend class Parser<0>;
   friend class Parser<1>;
 
 public:
-  /**
-   * @brief get idx
-   *
-   * @return std::tuple<std::string, std::string>
-   */
-  std::tuple<std::string, std::string> idx()
-  {
-    return std::make_tuple(m_short, m_long);
-  }
-
-  /**
-   * @brief get raw name
-   *
-   * @return std::string
-   */
-  std::string raw()
-  {
-    return m_raw_name;
-  }
-
-  /**
-   * @brief set default value
-   *
-   * @param default_value
-   * @return param_t
-   */
-  param_t def(const std::string& default_value)
-  {
-    m_default = default_value;
-    m_str_value = m_default;
-    m_has_default = true;
-    return shared_from_this();
-  }
-
-  /**
-   * @brief set checker
-   *
-   * @param checker_callback
-   * @return param_t
-   */
-  param_t checker(checker_fn_t checker_callback)
-  {
-    if (m_is_flag)
-    {
-      ex::ExHandler::get().push(
-        ex::IncompatibleError(utils::wrap(m_raw_name, "[]") + "~ A flag cannot have a checker."));
-    }
-    c_checkers.push_back(checker_callback);
-    return shared_from_this();
-  }
-
-  //param_t checker_mode(CheckerMode mode)
-  //{
-  //  m_check_mode = mode;
-  //}
-
-  /**
-   * @brief set setter (auto from variable reference)
-   *
-   * @tparam T
-   * @param var
-   * @return param_t
+  /**
+   * @brief get the action triggered by the command line (help, version)
+   *
+   * @return Action
    */
-  template<typename T>
-  param_t setter(T& var)
+  Action action() const
   {
-    c_setter = get_setter<T>(var);
-    return shared_from_this();
+    return m_action;
   }
 
   /**
-   * @brief set setter
+   * @brief get the name of the parsed command
    *
-   * @param setter_callback
-   * @return param_t
+   * @return const std::string&
    */
-  param_t setter_c(setter_fn_t setter_callback)
+  const std::string& command() const
   {
-    c_setter = setter_callback;
-    return shared_from_this();
+    return m_cmd_name;
   }
 
   /**
-   * @brief set callback
-   *
-   * Callback is called if parameter is used by user.
+   * @brief check if a param is set
    *
-   * @param callback
-   * @return param_t
+   * @param h
+   * @return true if set by the user or by default
    */
-  param_t callback(callback_fn_t callback)
+  bool is_set(handle_t h) const
   {
-    c_callback = callback;
-    m_callback_trigger = true;
-    return shared_from_this();
+    return m_states.at(h.id).m_is_set;
   }
 
   /**
-   * @brief set dependencies
+   * @brief get str value of a param
    *
-   * see @link 04_bcli_deps_bans.cpp @endlink
-   *
-   * @param checker
-   * @param p
-   * @param pchecker
-   * @return param_t
+   * @param h
+   * @return const std::string&
    */
-  param_t depends_on(check::checker_fn_t checker, param_t p, check::checker_fn_t pchecker = nullptr)
+  const std::string& value(handle_t h) const
   {
-    m_depends_on.push_back({checker, p, pchecker});
-    return shared_from_this();
+    return m_states.at(h.id).m_str_value;
   }
 
   /**
-   * @brief
-   *
-   * see @link 04_bcli_deps_bans.cpp @endlink
+   * @brief get typed value of a param, see Parser::get
    *
-   * @param checker
-   * @param p
-   * @param pchecker
-   * @return param_t
+   * @tparam T
+   * @param h
+   * @return T
    */
-  param_t banned(check::checker_fn_t checker, param_t p, check::checker_fn_t pchecker = nullptr)
+  template<typename T, typename R = typename param::as_ret<T>::type>
+  R get(handle_t h)
   {
-    m_banned.push_back({checker, p, pchecker});
-    return shared_from_this();
+    param::State& st = m_states.at(h.id);
+    if constexpr(!std::is_same_v<T, bool>)
+      (*m_index)[h.id]->check_value(st);
+    if constexpr(std::is_same_v<T, bool>)
+      return st.m_is_set;
+    else if constexpr(utils::is_vector_v<T>)
+      return st.values<typename T::value_type>((*m_index)[h.id]->is_multi());
+    else if constexpr(std::is_arithmetic_v<T> || utils::is_string_v<T>)
+      return utils::from_string<T>(st.m_str_value);
+    else
+      return utils::lexical_cast<T>(st.m_str_value);
   }
 
   /**
-   * @brief use param as flag (without value)
+   * @brief get positional arguments
    *
-   * @return param_t
+   * @return const utils::FrontCodedStore&
    */
-  param_t as_flag()
+  const utils::FrontCodedStore& get_positionals() const
   {
-    if (c_checker)
-    {
-      ex::ExHandler::get().push(
-        ex::IncompatibleError(
-          utils::wrap(m_raw_name, "[]") + "~ A param with checker cannot be a flag."));
-    }
-    m_is_flag = true;
-    m_has_default = true;
-    return shared_from_this();
+    return m_positionals;
   }
 
   /**
-   * @brief set metavar
-   *
-   * Metavar shown in usage: \n
-   * meta("INT") -> -i/--integer <INT> \n
-   * meta("FILE") -> --file <FILE> \n
+   * @brief wait for the checkers running in background, see Parser::sync
    *
-   * @param meta
-   * @return param_t
+   * @return true if all passed, otherwise failures are added to errors
    */
-  param_t meta(const std::string& meta)
+  bool sync()
   {
-    m_meta = meta;
-    return shared_from_this();
+    bool ok = true;
+    for (size_t i=0; i<m_states.size(); i++)
+    {
+      if (auto [res, msg] = (*m_index)[i]->wait_async(m_states[i]); !res)
+      {
+        m_errors.push_back(ex::CheckFailedError(msg));
+        ok = false;
+      }
+    }
+    return ok;
   }
 
   /**
-   * @brief set action
+   * @brief check if the last parse succeeded, see Parser::try_parse
    *
-   * @see bc::Action
-   *
-   * @param action
-   * @return param_t
+   * @return true if no error was collected
    */
-  param_t action(Action action)
+  bool ok() const
   {
-    m_action = action;
-    return shared_from_this();
+    return m_errors.empty();
   }
 
-  param_t hide()
+  explicit operator bool() const
   {
-    m_hidden = true;
-    return shared_from_this();
+    return ok();
   }
 
   /**
-   * @brief get str value
+   * @brief get the errors collected by Parser::try_parse, in command line order
    *
-   * @return const std::string&
+   * @return const std::vector<ex::BCliError>&
    */
-  const std::string& value()
+  const std::vector<ex::BCliError>& errors() const
   {
-    return m_str_value;
+    return m_errors;
   }
 
   /**
-   * @brief get default value
+   * @brief get the exit code of the first error
    *
-   * @return const std::string&
+   * @return ex::ExitCodes
    */
-  const std::string& get_def()
+  ex::ExitCodes exit_code() const
   {
-    return m_default;
+    return m_errors.empty() ? ex::ExitCodes::Sucess : m_errors.front().get_exit_code();
+  }
+
+PRIVATE:
+  void init(const std::vector<param::Param*>& index)
+  {
+    m_index = &index;
+    m_states.resize(index.size());
+    for (size_t i=0; i<index.size(); i++)
+      m_states[i].reset(index[i]->get_def());
+    m_positionals.clear();
+    m_errors.clear();
+    m_action = Action::Nothing;
+    m_cmd_name.clear();
+    m_cmd = nullptr;
+  }
+
+PRIVATE:
+  const std::vector<param::Param*>* m_index {nullptr};
+  std::vector<param::State>         m_states {};
+  utils::FrontCodedStore            m_positionals {};
+  std::vector<ex::BCliError>        m_errors {};
+  param::Command*                   m_cmd {nullptr};
+  std::string                       m_cmd_name {};
+  Action                            m_action {Action::Nothing};
+};
+
+/**
+ * @ingroup Parser
+ * @brief Token
+ *
+ * An event yielded by Parser::tokens: a param with its value (empty for flags), or a
+ * positional. Views point into argv, or for positionals read from a stream (see
+ * Parser::positionals_from) into a buffer valid until the next token.
+ */
+struct Token
+{
+  enum class Kind {Param, Positional};
+
+  Kind             kind {Kind::Positional};
+  handle_t         handle {};
+  std::string_view value {};
+};
+
+#define ENABLE_IF(n)                                               \
+template<int M = Mode,                                             \
+         typename = typename std::enable_if<M == n, void>::type>   \
+
+#define ENABLE_IF_P(n, pack)                                       \
+template<pack,                                                     \
+         int M = Mode,                                             \
+         typename = typename std::enable_if<M == n, void>::type>   \
+
+#if BCLI_EXCEPTIONS
+#define BCLI_PARSE(parser, argc, argv) \
+try {                                  \
+  parser.parse(argc, argv);            \
+} catch (const bc::ex::BCliError& e) { \
+  bc::utils::exit_bcli(e);             \
+  exit(EXIT_FAILURE);                  \
+}                                      \
+
+#else
+#define BCLI_PARSE(parser, argc, argv) \
+  parser.parse(argc, argv);            \
+
+#endif
+
+/**
+ * @ingroup Parser
+ * @brief bcli parser
+ *
+ * @tparam Mode 0: classical, 1: multiple commands
+ */
+template<int Mode = 0>
+class Parser
+{
+public:
+  Parser(const std::string& name,
+         const std::string& desc,
+         const std::string& version,
+         const std::string& authors = {})
+    : m_name(name), m_desc(desc), m_version(version), m_authors(authors)
+  {
+    m_current_cmd->add(m_current_group);
   }
 
   /**
-   * @brief check if param is set
+   * @ingroup Parser
+   * @brief parse argv
    *
-   * @return true
-   * @return false
+   * @param argc
+   * @param argv
    */
-  bool is_set()
+  void parse(int argc, char* argv[])
   {
-    return m_is_set;
+    freeze();
+    m_ctx.cmd = m_current_cmd.get();
+    m_ctx.select = &m_current_cmd;
+
+    switch (parse(m_ctx, argc, argv))
+    {
+    case Action::ShowHelp:
+      show_help();
+      BCLI_THROW(ex::BCliError("", "", ex::ExitCodes::Failure));
+    case Action::ShowVersion:
+      show_version();
+      BCLI_THROW(ex::BCliError("", "", ex::ExitCodes::Failure));
+    default: break;
+    }
   }
 
   /**
-   * @brief get param value
+   * @ingroup Parser
+   * @brief parse argv into a Result
    *
-   * Support:
-   * - Arithmetic types (int, float, double...)
-   * - bool
-   * - std::string
+   * The parser is only read: several threads can parse concurrently against the same
+   * frozen parser (see Parser::freeze), each with its own Result.
+   * Setters, callbacks and positionals setter are not called, and help/version are
+   * not printed but reported by Result::action.
    *
-   * Example:
    * @code
-   * bc::param_t p;
-   * int v = p->as<int>();
+   * cli.freeze();
+   * // in each thread
+   * bc::Result res;
+   * cli.parse(argc, argv, res);
+   * int k = res.get<int>(kmer_size_handle);
    * @endcode
    *
-   * @endcode
+   * @param argc
+   * @param argv
+   * @param result
+   */
+  void parse(int argc, char* argv[], Result& result) const
+  {
+    if (!frozen())
+      BCLI_THROW(ex::NotFrozenError("Parser::freeze must be called before a concurrent parse."));
+    result.init(m_index);
+    Ctx ctx;
+    ctx.cmd = m_current_cmd.get();
+    ctx.result = &result;
+    result.m_action = parse(ctx, argc, argv);
+    result.m_cmd_name = ctx.cmd->name();
+    result.m_cmd = ctx.cmd;
+  }
+
+  /**
+   * @ingroup Parser
+   * @brief parse argv into a Result, without throwing or exiting
    *
-   * Extend for custom types:
-   * @code
-   * class MyClass
-   * {
-   * public:
-   *   MyClass(std::string one, int i) {}
-   * };
+   * Same as parse(argc, argv, result), but usage errors are collected in the result
+   * instead of being thrown, and parsing goes on after an error to report all of them.
+   * Usable with -fno-exceptions.
    *
-   * template<>
-   * MyClass bc::param::Param::as<MyClass>()
-   * {
-   *   return MyClass(m_str_value, 10);
-   * }
-   * @endcode
-   * Then:
    * @code
-   * bc::param_t p;
-   * MyClass c = p->as<MyClass>();
+   * cli.freeze();
+   * bc::Result res;
+   * if (!cli.try_parse(argc, argv, res))
+   *   for (auto& e : res.errors())
+   *     std::cerr << e.get_name() << " " << e.get_msg() << std::endl;
    * @endcode
    *
-   *
-   * @tparam T
-   * @return T
+   * @param argc
+   * @param argv
+   * @param result
+   * @return true if no error
    */
-  template<typename T>
-  T as()
-  {
-    if constexpr(std::is_same_v<T, bool>)
-      return m_is_set;
-    else
-      return utils::lexical_cast<T>(m_str_value);
-  }
-
-PRIVATE:
-  Param(const std::string& name,
-        const std::string& help,
-        setter_fn_t setter,
-        checker_fn_t checker)
-    : m_raw_name(name), m_help(help), c_setter(setter)
+  bool try_parse(int argc, char* argv[], Result& result) const noexcept
   {
-    for (auto& v : utils::split(name, '/'))
+    result.init(m_index);
+    if (!frozen())
     {
-      if (utils::is_short_param(v))
-        m_short = utils::trim_param(v);
-      else if (utils::is_long_param(v))
-        m_long = utils::trim_param(v);
-      else
-      {
-        ex::ExHandler::get().push(
-          ex::InvalidParamError(
-            name + " -> " + utils::wrap(v, "\"\"") + " is neither a valid short nor a valid long param")
-         );
-      }
-      m_has_pname = true;
+      result.m_errors.push_back(
+        ex::NotFrozenError("Parser::freeze must be called before try_parse."));
+      return false;
     }
-    if (checker) c_checkers.push_back(checker);
-  }
-
-  const std::vector<std::tuple<checker_fn_t, param_t, checker_fn_t>>& get_dependency()
-  {
-    return m_depends_on;
-  }
-
-  const std::vector<std::tuple<checker_fn_t, param_t, check::checker_fn_t>>& get_banned()
-  {
-    return m_banned;
-  }
-
-  bool is_required()
-  {
-    return !m_has_default;
-  }
-
-  void set()
-  {
-    m_is_set = true;
-    m_str_value = FLAG_VALUE;
+    Ctx ctx;
+    ctx.cmd = m_current_cmd.get();
+    ctx.result = &result;
+    ctx.errors = &result.m_errors;
+#if BCLI_EXCEPTIONS
+    try
+    {
+#endif
+      result.m_action = parse(ctx, argc, argv);
+      result.m_cmd_name = ctx.cmd->name();
+      result.m_cmd = ctx.cmd;
+#if BCLI_EXCEPTIONS
+    }
+    catch (const ex::BCliError& e)
+    {
+      result.m_errors.push_back(e);
+    }
+    catch (const std::exception& e)
+    {
+      result.m_errors.push_back(
+        ex::BCliError("UnknownError", e.what(), ex::ExitCodes::UnknownError));
+    }
+#endif
+    return result.ok();
   }
 
-  std::string sp() const
+  /**
+   * @ingroup Parser
+   * @brief parse argv into a new Result, without throwing or exiting
+   *
+   * @param argc
+   * @param argv
+   * @return Result
+   */
+  Result try_parse(int argc, char* argv[]) const
   {
-    if (m_short.empty())
-      return m_short;
-    return std::string("-") + m_short;
+    Result result;
+    try_parse(argc, argv, result);
+    return result;
   }
 
-  std::string lp() const
-  {
-    if (m_long.empty())
-      return m_long;
-    return std::string("--") + m_long;
-  }
+  class Tokens;
 
-  bool hidden() const
+  /**
+   * @ingroup Parser
+   * @brief parse argv lazily, token by token
+   *
+   * Each step processes the next argv token into the result, as try_parse does, then
+   * yields the params and positionals it contains. Once argv is exhausted, the final
+   * checks (required params, constraints, ...) are run. Errors are collected in the
+   * result.
+   *
+   * @code
+   * cli.freeze();
+   * bc::Result res;
+   * for (const bc::Token& t : cli.tokens(argc, argv, res))
+   *   if (t.kind == bc::Token::Kind::Positional)
+   *     pool.enqueue(std::string(t.value));
+   * if (!res) ...
+   * @endcode
+   *
+   * @param argc
+   * @param argv
+   * @param result
+   * @return Tokens, an input range of Token
+   */
+  Tokens tokens(int argc, char* argv[], Result& result) const
   {
-    return m_hidden;
+    return Tokens(*this, argc, argv, result);
   }
 
-  Action get_action() const
+  /**
+   * @ingroup Parser
+   * @brief clear all per-parse state
+   *
+   * Values, positionals and parser state are cleared in O(params), the schema and
+   * buffers are kept. Variables bound with setters are not reset.
+   */
+  void reset()
   {
-    return m_action;
+    for (auto& p : m_index)
+      p->reset();
+    for (auto& cmd : commands())
+      cmd->reset();
+    m_ctx.current.clear();
+    m_ctx.param = nullptr;
+    m_ctx.is_param = false;
+    m_ctx.end_of_options = false;
+    m_ctx.last_is_flag = false;
+    m_ctx.bypass = false;
+    m_ctx.checked.clear();
   }
 
-  const std::string& get_help() const
+  /**
+   * @ingroup Parser
+   * @brief reset then parse argv
+   *
+   * @param argc
+   * @param argv
+   */
+  void reparse(int argc, char* argv[])
   {
-    return m_help;
+    reset();
+    parse(argc, argv);
   }
 
-  const std::string& get_meta() const
+  /**
+   * @ingroup Parser
+   * @brief wait for the checkers running in background, see Param::checker_async
+   *
+   * All failures are thrown at once in a CheckFailedError.
+   */
+  void sync() const
   {
-    return m_meta;
+    if (!m_ctx.cmd)
+      return;
+    std::vector<std::string> failed;
+    for (auto& group : *m_ctx.cmd)
+      for (auto& p : *group)
+        if (auto [res, msg] = p->wait_async(*p); !res)
+          failed.push_back(msg);
+    if (!failed.empty())
+      BCLI_THROW(ex::CheckFailedError(utils::join(failed, "\n")));
   }
 
-  bool has_short()
+  /**
+   * @ingroup Parser
+   * @brief update the value of a param after a parse
+   *
+   * Only the checkers of the param and the constraints involving it (depends_on,
+   * banned, groups, relations) are run, then setters and callback are called.
+   * On failure, the previous value is kept and the error is thrown.
+   * For flags, "", "0" and "false" unset the flag and reset the bound variable.
+   * A vector bound with Param::setter is replaced, not appended to.
+   *
+   * @code
+   * BCLI_PARSE(cli, argc, argv)
+   * cli.update(kmer_size_handle, "25");
+   * @endcode
+   *
+   * @param h
+   * @param value
+   */
+  void update(handle_t h, const std::string& value)
   {
-    return !m_short.empty();
+    update(m_ctx, (*this)[h], value);
   }
 
-  bool has_long()
+  /**
+   * @ingroup Parser
+   * @brief update the value of a param after a parse, see update(handle_t, value)
+   *
+   * @param pname
+   * @param value
+   */
+  void update(const std::string& pname, const std::string& value)
   {
-    return !m_long.empty();
+    update(handle(pname), value);
   }
 
-  bool has_both()
+  /**
+   * @ingroup Parser
+   * @brief update the value of a param in a Result, see update(handle_t, value)
+   *
+   * Setters and callbacks are not called.
+   *
+   * @param result
+   * @param h
+   * @param value
+   */
+  void update(Result& result, handle_t h, const std::string& value) const
   {
-    return has_short() && has_long();
+    Ctx ctx;
+    ctx.cmd = result.m_cmd;
+    ctx.result = &result;
+    update(ctx, (*this)[h], value);
   }
 
-  bool is_flag()
+public:
+  /**
+   * @ingroup Parser
+   * @brief add commmand
+   *
+   * @param name command name
+   * @param desc command description
+   * @param help command help
+   * @return param::cmd_t
+   */
+  ENABLE_IF(1)
+  param::cmd_t add_command(const std::string& name,
+                     const std::string& desc,
+                     param::help_fn_t help = nullptr)
   {
-    return m_is_flag;
+    m_frozen = false;
+    param::cmd_t cmd = param::make_cmd(name, desc, help);
+    m_current_cmd = cmd;
+    m_current_cmd->add(param::make_group(conf::get().m_default_grp, ""));
+    m_cmds->add(cmd);
+    m_is_cmd_mode = true;
+    return cmd;
   }
 
-  void process(const std::string& value)
+  ENABLE_IF(1)
+  bool is(const std::string& cmd_name)
   {
-    m_str_value = value;
-    if (!c_checkers.empty())
-    {
-      for (auto& cc : c_checkers)
-      {
-        auto [res, msg] = cc(m_raw_name, m_str_value);
-        if (!res)
-          throw ex::CheckFailedError(msg);
-      }
-      m_has_valid_value = true;
-    }
-    m_is_set = true;
-    if (c_setter)
-    {
-      c_setter(value);
-    }
-    if (c_callback && m_callback_trigger && !m_as_default)
-    {
-      c_callback();
-    }
+    return (cmd_name == m_current_cmd->name());
   }
 
-  void process_def()
+  /**
+   * @ingroup Parser
+   * @brief add group
+   *
+   * @param name group name
+   * @param desc group description
+   * @return param::pgroup_t
+   */
+  ENABLE_IF(0)
+  param::pgroup_t add_group(const std::string& name,
+                            const std::string& desc)
   {
-    m_as_default = true;
-    process(m_str_value);
+    m_frozen = false;
+    if (m_current_group != m_current_cmd->get(m_current_group->name()))
+      m_current_cmd->add(m_current_group);
+    m_current_group = param::make_group(name, desc);
+    m_current_cmd->add(m_current_group);
+    return m_current_group;
   }
 
-PRIVATE:
-  std::string m_raw_name  {};
-  std::string m_str_value {};
-  std::string m_help      {};
-  std::string m_default   {};
-  std::string m_short     {};
-  std::string m_long      {};
-  std::string m_meta      {conf::get().m_default_meta};
-
-  Action m_action {Action::Nothing};
-
-  std::vector<std::tuple<checker_fn_t, param_t, checker_fn_t>> m_depends_on {};
-  std::vector<std::tuple<checker_fn_t, param_t, checker_fn_t>> m_banned {};
-
-  bool m_has_default     {false};
-  bool m_has_valid_value {false};
-  bool m_has_pname       {false};
-  bool m_is_set          {false};
-  bool m_is_flag         {false};
-
-  bool m_as_default      {false};
-  bool m_hidden          {false};
-  //CheckerMode m_check_mode {CheckerMode::AND};
-
-PRIVATE:
-  setter_fn_t      c_setter;
-  checker_fn_t     c_checker;
-  std::vector<checker_fn_t> c_checkers;
-  callback_fn_t    c_callback;
-
-  bool m_callback_trigger {false};
-};
-
-/**
- * @ingroup Param
- * @brief make a std::shared_ptr<Param>
- *
- * @param name parameter name -> "-p" || "--param" || "-p/--param"
- * @param help parameter help
- * @param setter a setter function
- * @param checker a checker function
- * @return param_t std::shared_ptr<Param>
- */
-inline param_t make(const std::string& name,
-                    const std::string& help,
-                    setter_fn_t setter = nullptr,
-                    checker_fn_t checker = nullptr)
-{
-  return std::make_shared<Param>(Param(name, help, setter, checker));
-}
-
-template<>
-inline param_t Param::setter<setter_fn_t>(setter_fn_t& setter_callback)
-{
-  c_setter = setter_callback;
-  return shared_from_this();
-}
-
-/**
- * @defgroup ParamGroup
- * @brief About bcli parameter groups
- */
-
-class ParamGroup;
-
-/**
- * @ingroup ParamGroup
- * @typedef pgroup_t
- * @brief pgroup_t
- *
- * ParamGroup constructor is private, ParamGroup is always used as std::shared_ptr<ParamGroup>
- */
-using pgroup_t = std::shared_ptr<ParamGroup>;
-
-/**
- * @ingroup ParamGroup
- * @brief ParamGroup
- *
- * ParamGroup class
- */
-class ParamGroup
-{
-  friend pgroup_t make_group(const std::string& name,
-                             const std::string& desc);
-  friend class Command;
-  friend class Parser<0>;
-  friend class Parser<1>;
-
-PRIVATE:
-  ParamGroup(const std::string& name,
-             const std::string& desc)
-    : m_name(name), m_desc(desc)
-  {}
-
-  std::string get_help()
-  {
-    if (m_hidden)
-      return "";
-
-    std::stringstream help;
-    const std::string& fsymb = conf::get().m_flag_symbol;
-    help.fill(' ');
-    help << utils::sp(2) << utils::wrap(m_name, "[]");
-    if (!m_desc.empty()) help << " - " << m_desc;
-    help << "\n";
-    auto [maxs, maxl] = padding();
-    for (auto& p : m_order)
-    {
-      if (p->hidden())
-        continue;
-      std::string fl = p->is_flag() ? " " + fsymb : "";
-      help << utils::sp(4);
-      if (!p->sp().empty())
-        help << std::setw(maxs) << std::right << p->sp();
-      else help << utils::sp(maxs);
-      help << " ";
-      if (!p->lp().empty())
-        help << std::setw(maxl) << std::left << p->lp();
-      else help << utils::sp(maxl-fl.size());
-
-      help <<" - " << p->get_help() << " ";
-
-      if (p->is_flag()) help << utils::wrap(fsymb, "[]");
-      if (!p->get_def().empty()) help << utils::wrap(p->get_def(), "{}");
-      help << "\n";
-    }
-    help << "\n";
-    return help.str();
+  /**
+   * @ingroup Parser
+   * @brief add common
+   *
+   * @param name name
+   * @return param::pgroup_t
+   */
+  ENABLE_IF(0)
+  param::pgroup_t add_common(const std::string& name = "common")
+  {
+    m_frozen = false;
+    m_current_cmd->add_common(name);
+    m_current_group = m_current_cmd->get(name);
+    return m_current_group;
   }
 
-public:
   /**
+   * @ingroup Parser
    * @brief add param
    *
-   * @param name param name (ex: "-p/--param")
-   * @param help parma help
-   * @return param_t
+   * @param name param name
+   * @param help param help
+   * @return param::param_t
    */
-  param_t add_param(const std::string& name,
-                    const std::string& help)
+  ENABLE_IF(0)
+  param::param_t add_param(const std::string& name,
+                           const std::string& help)
   {
-    param_t p = make(name, help);
-    add(p);
+    m_frozen = false;
+    param::param_t p = param::make(name, help);
+    m_current_group->add(p);
     return p;
   }
 
   /**
-   * @brief get param_t
+   * @ingroup Parser
+   * @brief get positional arguments
    *
-   * @param pname param name
-   * @return param_t
+   * Positionals are front-coded, they can be iterated without allocation, see
+   * utils::FrontCodedStore. This used to return a std::vector<std::string>, the store
+   * converts to and compares with one, and iterates with auto&.
+   *
+   * @code
+   * for (auto& path : cli.get_positionals()) // valid until the next iteration
+   *   ...
+   * std::vector<std::string> pos = cli.get_positionals(); // copy
+   * @endcode
+   *
+   * @return const utils::FrontCodedStore&
    */
-  param_t get(const std::string& pname)
-  {
-    if (m_params.count(pname) > 0)
-      return m_params.at(pname);
-    else
-      throw ex::UnknownParamError(pname + "doesn't exist in group " + m_name);
-  }
-
-  auto begin() { return m_order.begin(); }
-  auto end() { return m_order.end(); }
-  auto begin() const { return m_order.begin(); }
-  auto end() const { return m_order.end(); }
-
-  void hide()
-  {
-    m_hidden = true;
-  }
-
-  bool hidden()
-  {
-    return m_hidden;
-  }
-
-PRIVATE:
-  bool exists(const std::string& pname)
-  {
-    std::string p = utils::trim_param(pname);
-    return m_params.count(p) > 0;
-  }
-
-  const std::string& name()
+  const utils::FrontCodedStore& get_positionals() const
   {
-    return m_name;
+    return m_current_cmd->get_positionals();
   }
 
-  bool empty()
+  /**
+   * @ingroup Parser
+   * @brief set number of positionals
+   *
+   * @param nb number of positionals
+   * @param usage positionals usage
+   * @param help positionals help
+   */
+  ENABLE_IF(0)
+  void set_positionals(size_t nb, const std::string& usage, const std::string& help)
   {
-    return m_order.size() == 0;
+    m_current_cmd->set_positionals(nb, usage, help);
   }
 
-  void add(param_t p)
+  /**
+   * @ingroup Parser
+   * @brief set positional bounds
+   *
+   * @param min min number of positionals
+   * @param max max number of positionals
+   * @param usage positionals usage
+   * @param help positionals help
+   */
+  ENABLE_IF(0)
+  void set_positional_bounds(size_t min, size_t max,
+                             const std::string& usage,
+                             const std::string& help)
   {
-    auto [sp, lp] = p->idx();
-    already_exists(p, sp, lp);
-    if (!sp.empty()) m_params.insert({sp, p});
-    if (!lp.empty()) m_params.insert({lp, p});
-    m_nbp++;
-    m_order.push_back(p);
+    m_current_cmd->set_positional_bounds(min, max, usage, help);
   }
 
-  std::tuple<int, int> padding()
+  /**
+   * @ingroup Parser
+   * @brief set positionals usage and help
+   *
+   * @param usage positionals usage
+   * @param help positionals help
+   */
+  ENABLE_IF(0)
+  void set_positionals_help(const std::string& usage, const std::string& help)
   {
-    size_t max_s = 0, max_l = 0;
-    for (auto& p: m_order)
-    {
-      max_s = p->sp().size() < max_s ? max_s : p->sp().size();
-      max_l = p->lp().size() < max_l ? max_l : p->lp().size();
-    }
-    return std::make_tuple(max_s, max_l);
+    m_current_cmd->set_positionals_help(usage, help);
   }
 
-  void already_exists(param_t p, const std::string& sp, const std::string& lp)
+  /**
+   * @ingroup Parser
+   * @brief set a group of mutually exclusive params
+   *
+   * @param params
+   */
+  ENABLE_IF(0)
+  void mutually_exclusive(const std::vector<param::param_t>& params)
   {
-    if (m_params.count(sp) > 0 || m_params.count(lp) > 0)
-    {
-      ex::ExHandler::get().push(
-        ex::AlreadyExistsError(p->raw() + " already exists in group " + m_name));
-    }
+    m_frozen = false;
+    m_current_cmd->mutually_exclusive(params);
   }
 
-PRIVATE:
-  std::string                              m_name {};
-  std::string                              m_desc {};
-  std::unordered_map<std::string, param_t> m_params {};
-  std::vector<param_t>                     m_order {};
-  size_t                                   m_nbp {0};
-  bool                                     m_hidden {false};
-};
-
-/**
- * @ingroup ParamGroup
- * @brief make a std::shared_ptr<ParamGroup>
- *
- * @param name group name
- * @param desc group description
- * @return pgroup_t
- */
-inline pgroup_t make_group(const std::string& name,
-                           const std::string& desc)
-{
-  return std::make_shared<ParamGroup>(ParamGroup(name, desc));
-}
-
-/**
- * @defgroup Command
- * @brief About bcli commands
- */
-
-class Command;
-
-/**
- * @ingroup Command
- * @typedef cmd_t
- * @brief Command constuctor is private, Command is always used as std::shared_ptr<Command>
- *
- */
-using cmd_t = std::shared_ptr<Command>;
-
-class Commands;
-/**
- * @ingroup Command
- * @brief Command
- *
- * Command class
- */
-class Command
-{
-  friend cmd_t make_cmd(const std::string& name,
-                        const std::string& desc,
-                        help_fn_t help);
-
-  friend class Parser<0>;
-  friend class Parser<1>;
-  friend class Commands;
-
-PRIVATE:
-  Command(const std::string& name,
-          const std::string& desc,
-          help_fn_t help = nullptr)
-    : m_name(name), m_desc(desc), m_help(help)
-  {}
-
-public:
   /**
-   * @brief set command help
+   * @ingroup Parser
+   * @brief set a group of params, at least one must have a value
    *
-   * @param help
+   * @param params
    */
-  void set_help(help_fn_t help)
+  ENABLE_IF(0)
+  void at_least_one(const std::vector<param::param_t>& params)
   {
-    m_help = help;
+    m_frozen = false;
+    m_current_cmd->at_least_one(params);
   }
 
   /**
-   * @brief add param to current group
+   * @ingroup Parser
+   * @brief set positionals checker
    *
-   * @param name parameter name (ex: "-p/--param")
-   * @param help  parameter help
-   * @return param_t
+   * @param checker
    */
-  param_t add_param(const std::string& name,
-                   const std::string& help)
+  ENABLE_IF(0)
+  void positionals_checker(check::checker_fn_t checker)
   {
-    return m_current_group->add_param(name, help);
+    m_current_cmd->positionals_checker(checker);
   }
 
   /**
-   * @brief add group to command
+   * @ingroup Parser
+   * @brief run the positionals checker in parallel, see Command::parallel_positional_checks
    *
-   * @param name group name
-   * @param desc group description
-   * @return pgroup_t
+   * @param nb_threads number of threads, 0 -> std::thread::hardware_concurrency()
    */
-  pgroup_t add_group(const std::string& name,
-                     const std::string& desc)
+  ENABLE_IF(0)
+  void parallel_positional_checks(size_t nb_threads = 0)
   {
-    param::pgroup_t group = make_group(name, desc);
-    add(group);
-    return group;
+    m_current_cmd->parallel_positional_checks(nb_threads);
   }
 
   /**
-   * @brief add a group with common parameters
+   * @ingroup Parser
+   * @brief expand positionals which are globs or directories, see
+   *        Command::expand_positionals
    *
-   * "-h/--help" -> trigger help \n
-   * "-v/--verbose" -> trigger version \n
-   * "-d/--debug" \n
-   * "--version" \n
-   * @see bc::Action
-   * @see Configuration
+   * @code
+   * cli.positionals_checker(check::seems_fastx);
+   * cli.expand_positionals();
+   * // app 'runs/sample_*.fq.gz' or app runs/
+   * @endcode
    *
-   * @param name group name
-   * @return pgroup_t
+   * @param nb_threads number of threads of the directory walker, 0 -> all
    */
-  pgroup_t add_common(const std::string& name = "common")
+  ENABLE_IF(0)
+  void expand_positionals(size_t nb_threads = 0)
   {
-    if (conf::get().has_common())
-    {
-      pgroup_t grp = add_group(name, {});
-      if (conf::get().m_help)
-        grp->add_param("-h/--help", "Show this message and exit.")
-           ->as_flag()->action(Action::ShowHelp);
-      if (conf::get().m_verbose)
-        grp->add_param("-v/--verbose", "Verbose mode.")->as_flag();
-      if (conf::get().m_debug)
-        grp->add_param("-d/--debug", "Debug mode.")->as_flag();
-      if (conf::get().m_version)
-       grp->add_param("--version", "Show version and exit.")
-           ->as_flag()->action(Action::ShowVersion);
-      return grp;
-    }
-    else
-      return nullptr;
+    m_current_cmd->expand_positionals(nb_threads);
   }
 
   /**
-   * @brief get parameter
+   * @ingroup Parser
+   * @brief detect input files given twice, see Command::dedup_inputs
    *
    * @code
-   * cmd->add_param("-p/--param", "help param");
-   *
-   * cmd->getp("p");
-   * cmd->getp("param");
-   * cmd->getp("-p");
-   * cmd->getp("--param");
-   *
+   * auto reads = cli.add_param("-r/--reads", "reads")->multi();
+   * cli.dedup_inputs(param::Dedup::Drop, {reads});
    * @endcode
-   * @param name
-   * @return param_t
+   *
+   * @param policy
+   * @param params multi-value params holding input files
    */
-  param_t getp(const std::string& name)
+  ENABLE_IF(0)
+  void dedup_inputs(param::Dedup policy, const std::vector<param::param_t>& params = {})
   {
-    std::string name_ = utils::trim_param(name);
-    for (auto& grp : m_order)
-      if (grp->exists(name_))
-        return grp->get(name_);
-    return nullptr;
+    m_current_cmd->dedup_inputs(policy, params);
   }
 
   /**
-   * @brief get positional parameters
+   * @ingroup Parser
+   * @brief set positionals setter, called on each positional
    *
-   * @return const std::vector<std::string>&
+   * @param setter
    */
-  const std::vector<std::string>& get_positionals() const
+  ENABLE_IF(0)
+  void positionals_setter(param::setter_fn_t setter)
   {
-    return m_positionals;
+    m_current_cmd->positionals_setter(setter);
   }
 
   /**
-   * @brief set positionals help
+   * @ingroup Parser
+   * @brief read positionals from a stream when "-" or "--inputs-from-stdin" is given
    *
-   * @param usage
-   * @param help
+   * @code
+   * cli.positionals_from(std::cin);
+   * cli.positionals_setter([&pool](const std::string& path) { pool.enqueue(path); });
+   * // find . -name "*.fa" | app -k 31 -
+   * @endcode
+   *
+   * @param in
    */
-  void set_positionals_help(const std::string& usage, const std::string& help)
+  ENABLE_IF(0)
+  void positionals_from(std::istream& in = std::cin)
   {
-    m_usage_pos = usage;
-    m_help_pos = help;
+    m_current_cmd->positionals_from(in);
   }
 
   /**
-   * @brief set number of positionals
+   * @ingroup Parser
+   * @brief set help
    *
-   * @param nb number of positionals
-   * @param usage
    * @param help
    */
-  void set_positionals(size_t nb,
-                       const std::string& usage,
-                       const std::string& help)
+  void set_help(std::function<std::string()> help)
   {
-    m_e_pos = nb;
-    m_usage_pos = usage;
-    m_help_pos = help;
-    m_checkp = true;
+    if constexpr(Mode == 0)
+      m_current_cmd->set_help(help);
+    else
+      m_cmds->set_help(help);
   }
 
   /**
-   * @brief set positionals bounds
+   * @ingroup Parser
+   * @brief set a deadline for the checkers doing I/O during a parse
    *
-   * @param min min number of positionals
-   * @param max max number of positionals
-   * @param usage
-   * @param help
+   * Checkers with a cost other than check::Cost::Pure (is_file, is_dir, check_magic, ...)
+   * run on worker threads and fail with a CheckFailedError once the deadline has passed,
+   * instead of hanging on a stale network mount. 0 disables the deadline (default).
+   *
+   * @param timeout
    */
-  void set_positional_bounds(size_t min, size_t max,
-                             const std::string& usage,
-                             const std::string& help)
+  void set_deadline(std::chrono::milliseconds timeout)
   {
-    m_l_pos = min;
-    m_u_pos = max;
-    m_usage_pos = usage;
-    m_help_pos = help;
-    m_checkp = true;
-    m_bmode = true;
+    m_deadline = timeout;
   }
 
   /**
-   * @brief set checker for positionals
+   * @ingroup Parser
+   * @brief get param
    *
-   * @param checker
+   * For "-p/--param":
+   * @code
+   * cli->getp("p");
+   * cli->getp("-p");
+   * cli->getp("param");
+   * cli->getp("--param");
+   * @endcode
+   * @param pname param name
+   * @return param_t
    */
-  void positionals_checker(checker_fn_t checker)
+  param_t getp(const std::string& pname) const
   {
-    c_pchecker = checker;
+    std::string pname_ = utils::trim_param(pname);
+    for (auto& group : *m_current_cmd)
+    {
+      if (group->exists(pname_))
+        return group->get(pname_);
+    }
+    return nullptr;
   }
 
-  void positionals_setter(setter_fn_t setter)
+  /**
+   * @ingroup Parser
+   * @brief freeze the schema
+   *
+   * Checks the cli (see ex::ExHandler) and indexes all params, called by parse.
+   * Params added after a freeze are indexed by the next one, existing handles stay valid.
+   * Nothing is rebuilt if the schema didn't change since the last freeze.
+   */
+  void freeze()
   {
-    c_psetter = setter;
+    size_t size = schema_size();
+    bool abbreviations = conf::get().m_abbreviations;
+    if (m_frozen && size == m_frozen_size && abbreviations == m_frozen_abbreviations)
+      return;
+
+    ex::ExHandler::get().check();
+    for (auto& cmd : commands())
+      for (auto& group : *cmd)
+        for (auto& p : *group)
+          if (!handle_t{p->id()}.valid())
+          {
+            p->m_id = static_cast<uint32_t>(m_index.size());
+            m_index.push_back(p.get());
+          }
+    for (auto& cmd : commands())
+    {
+      cmd->m_constraints.compile(cmd->m_order, cmd->m_exclusive, cmd->m_at_least_one,
+                                 m_index.size());
+      cmd->m_names = cmd->names();
+      // the first registration of a name wins, as with the linear lookup
+      cmd->m_lookup.clear();
+      for (auto& group : *cmd)
+        for (auto& p : *group)
+          for (const std::string* name : {&p->m_short, &p->m_long})
+            if (!name->empty())
+              cmd->m_lookup.try_emplace(*name, p.get());
+      if (conf::get().m_abbreviations)
+        cmd->m_long_names = cmd->long_names();
+    }
+    m_cmds->m_names = m_cmds->names();
+    static std::atomic<uint64_t> freezes {0};
+    m_freeze_id = ++freezes;
+    m_frozen_size = size;
+    m_frozen_abbreviations = abbreviations;
+    m_frozen = true;
   }
 
-  auto begin() { return m_order.begin(); }
-  auto end() { return m_order.end(); }
-  auto begin() const { return m_order.begin(); }
-  auto end() const { return m_order.end(); }
+  /**
+   * @ingroup Parser
+   * @brief get a handle on a param of the current command
+   *
+   * The lookup is done once, then access by handle is O(1) and doesn't touch any
+   * std::shared_ptr refcount, see Parser::get.
+   *
+   * @code
+   * handle_t k = cli.handle("kmer-size");
+   * BCLI_PARSE(cli, argc, argv)
+   * // in worker threads
+   * int ks = cli.get<int>(k);
+   * @endcode
+   *
+   * @param pname param name
+   * @return handle_t
+   */
+  handle_t handle(const std::string& pname)
+  {
+    param::param_t p = getp(pname);
+    if (!p)
+      BCLI_THROW(ex::UnknownParamError(pname + " doesn't exist."));
+    return handle(p);
+  }
 
-PRIVATE:
-  std::string& name()
+  /**
+   * @ingroup Parser
+   * @brief get a handle on a param
+   *
+   * @param p a param registered in this parser
+   * @return handle_t
+   */
+  handle_t handle(param::param_t p)
   {
-    return m_name;
+    // an id past the index is either not indexed yet or from another parser
+    if (!handle_t{p->id()}.valid() || p->id() >= m_index.size())
+      freeze();
+    if (!handle_t{p->id()}.valid() || p->id() >= m_index.size() ||
+        m_index[p->id()] != p.get())
+      BCLI_THROW(ex::UnknownParamError(p->raw() + " doesn't belong to this parser."));
+    return handle_t{p->id()};
   }
 
-  std::string& desc()
+  /**
+   * @ingroup Parser
+   * @brief get a param from a handle
+   *
+   * @param h
+   * @return param::Param&
+   */
+  param::Param& operator[](handle_t h) const
   {
-    return m_desc;
+    assert(h.id < m_index.size());
+    return *m_index[h.id];
   }
 
-  std::string get_help(const std::string& main_name, const std::string& version, bool cmd_mode)
+  /**
+   * @ingroup Parser
+   * @brief get a param value from a handle
+   *
+   * Arithmetic types and strings are converted with utils::from_string, others with
+   * Param::as. Concurrent calls are safe once parsing is done, except for the first
+   * std::vector<T> access of a param not declared with multi<T> (converted and cached).
+   *
+   * @tparam T
+   * @param h
+   * @return T
+   */
+  template<typename T, typename R = typename param::as_ret<T>::type>
+  R get(handle_t h) const
   {
-    if (m_help)
-      return m_help();
+    param::Param& p = (*this)[h];
+    if constexpr((std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || utils::is_string_v<T>)
+      return utils::from_string<T>(p.value());
     else
-    {
-      std::stringstream ss;
-      ss << main_name << " ";
-      if (cmd_mode) ss << m_name << " ";
-      ss << version << "\n\n";
-
-      ss << "DESCRIPTION" << "\n" << utils::sp(2);
-      ss << m_desc << "\n\n";
-
-      ss << "USAGE" << "\n" << utils::sp(2);
-      if (cmd_mode) ss << main_name << " ";
-      ss << m_name << " " << get_usage(main_name, cmd_mode) << "\n\n";
-      if (!m_help_pos.empty())
-      {
-        ss << "POSITIONALS" << "\n";
-        ss << utils::sp(2) << m_help_pos << "\n\n";
-      }
-      ss << "OPTIONS" << "\n";
-      for (auto& g : m_order)
-        if (!g->empty())
-          ss << g->get_help();
-      return ss.str();
-    }
+      return p.as<T>();
   }
 
-  std::string get_usage(const std::string& main_name, bool cmd_mode)
+  /**
+   * @ingroup Parser
+   * @brief fill a struct from parsed values
+   *
+   * Members are stored directly from the param values (std::from_chars for arithmetic
+   * types), in one pass, according to bc::fields<S> (see BCLI_FIELDS). Must be called
+   * after parse. Members of unset params without default are left untouched.
+   *
+   * @code
+   * BCLI_PARSE(cli, argc, argv)
+   * Options opt = cli.bind<Options>();
+   * @endcode
+   *
+   * @tparam S struct type
+   * @return S
+   */
+  template<typename S>
+  S bind() const
   {
-    std::stringstream ss;
-    std::vector<std::string> required;
-    std::vector<std::string> optionals;
-    std::vector<std::string> flags;
-
-    for (auto& group : m_order)
-    {
-      if (group->hidden())
-        continue;
-      for (auto& p : *group)
-      {
-        if (p->hidden())
-          continue;
-        std::string bds = p->is_required() ? "" : "[]";
-        std::string raw;
-        if (p->is_flag())
-          raw = p->raw();
-        else
-          raw = p->raw() + " " + utils::wrap(p->get_meta(), "<>");
-        std::string fm = utils::wrap(raw, bds);
-
-        if (p->is_required())
-          required.push_back(fm);
-        else if (p->is_flag())
-          flags.push_back(fm);
-        else
-          optionals.push_back(fm);
-      }
-    }
-
-    size_t pad;
-    if (cmd_mode) pad = main_name.size() + 1 + m_name.size();
-    else pad = m_name.size();
-
-    auto format = [&ss, &pad](const std::vector<std::string> vec, int c) -> int {
-      size_t max_size = 90;
-      int current = c;
-      for (auto& f : vec)
-      {
-        if (current + f.size() < max_size)
-        {
-          ss << f << " ";
-          current += f.size();
-        }
-        else
-        {
-          ss << "\n" << utils::sp(pad+3) << f << " ";
-          current = f.size()+pad+3;
-        }
-      }
-      return current;
-    };
-    format(flags, format(optionals, format(required, 0)));
-    ss << m_usage_pos;
-    return ss.str();
+    S s {};
+    bind(s);
+    return s;
   }
 
-  std::tuple<bool, std::string> check_positionals()
+  /**
+   * @ingroup Parser
+   * @brief fill a struct from parsed values
+   *
+   * @see Parser::bind()
+   *
+   * @tparam S struct type
+   * @param s struct to fill
+   */
+  template<typename S>
+  void bind(S& s) const
   {
-    if (m_checkp)
-    {
-      if (m_bmode)
-      {
-        if (m_positionals.size() < m_l_pos)
-          return std::make_tuple(
-            false,
-            "requires at least " + std::to_string(m_l_pos) + " positionals.");
-        else if (m_positionals.size() > m_u_pos)
-          return std::make_tuple(
-            false,
-            "requires at most " + std::to_string(m_u_pos) + " positionals.");
-      }
-      else
-        return std::make_tuple(
-          m_positionals.size() == m_e_pos,
-          "number of positionals must be " + std::to_string(m_e_pos)
-        );
-    }
+    bind(s, fields<S>::value);
+  }
+
+  /**
+   * @ingroup Parser
+   * @brief fill a struct from parsed values, with an explicit field list
+   *
+   * @code
+   * cli.bind(opt, std::make_tuple(bc::field(&Options::k, "-k/--kmer-size")));
+   * @endcode
+   *
+   * @tparam S struct type
+   * @tparam Fields field_t...
+   * @param s struct to fill
+   * @param f a tuple of field_t
+   */
+  template<typename S, typename... Fields>
+  void bind(S& s, const std::tuple<Fields...>& f) const
+  {
+    using names_t = std::array<const char*, sizeof...(Fields)>;
+    // handles resolved at the first bind of a field list, per freeze and command
+    struct Bound
+    {
+      uint64_t                                freeze {0};
+      const param::Command*                   cmd {nullptr};
+      names_t                                 names {};
+      std::array<handle_t, sizeof...(Fields)> handles {};
+    };
+    thread_local Bound bound;
 
-    if (c_pchecker)
+    if (!frozen())
     {
-      int i = 0;
-      for (auto& p : m_positionals)
-      {
-        auto [res, msg] = c_pchecker("positionals" + utils::wrap(std::to_string(i), "[]"), p);
-        if (!res)
-          return std::make_tuple(res, msg);
-        i++;
-      }
+      std::apply([this, &s](const auto&... field) {
+        (field.store(s, *get_bound(field.key())), ...);
+      }, f);
+      return;
     }
 
-    return std::make_tuple(true, "");
-  }
-
-  void push_positionals(const std::string& arg)
-  {
-    m_positionals.push_back(arg);
-    m_nb_pos++;
-    if (c_psetter)
-      c_psetter(arg);
+    names_t names = std::apply([](const auto&... field) {
+      return names_t{field.name...};
+    }, f);
+    if (bound.freeze != m_freeze_id || bound.cmd != m_current_cmd.get() || bound.names != names)
+    {
+      bound.handles = std::apply([this](const auto&... field) {
+        return std::array<handle_t, sizeof...(Fields)>{handle_t{get_bound(field.key())->id()}...};
+      }, f);
+      bound.freeze = m_freeze_id;
+      bound.cmd = m_current_cmd.get();
+      bound.names = names;
+    }
+    std::apply([this, &s](const auto&... field) {
+      size_t n = 0;
+      (field.store(s, (*this)[bound.handles[n++]]), ...);
+    }, f);
   }
 
-  void add(pgroup_t pg)
+  void show_help()
   {
-    if (m_groups.count(pg->name()) > 0)
+    if (!m_is_cmd_mode || m_ctx.bypass)
     {
-      ex::ExHandler::get().push(
-        ex::AlreadyExistsError(pg->name() + "group already exists in command " + m_name));
+      std::cerr << m_current_cmd->get_help(m_name, m_version, m_ctx.bypass) << std::endl;
     }
     else
     {
-      m_groups.insert({pg->name(), pg});
-      m_order.push_back(pg);
-      m_current_group = pg;
+      std::cerr << m_cmds->get_help() << std::endl;
     }
   }
 
-  pgroup_t get(const std::string& name)
+PRIVATE:
+  // cheap fingerprint of the schema, see freeze
+  size_t schema_size() const
   {
-    if (m_groups.count(name) == 0)
-      throw ex::UnknownGroupError(name + "doesn't exist in command " + m_name);
-    else
-      return m_groups.at(name);
+    size_t size = m_cmds->m_order.size();
+    for (auto& cmd : commands())
+      size += cmd->schema_size();
+    return size;
   }
 
-PRIVATE:
-  std::string m_name {};
-  std::string m_desc {};
-  help_fn_t   m_help {nullptr};
-  pgroup_t    m_def_group {make_group("", "")};
-  pgroup_t    m_current_group {};
-  bool        m_def_use {false};
-  size_t      m_nb_pos {0};
-  std::unordered_map<std::string, pgroup_t> m_groups;
-  std::vector<pgroup_t>                     m_order;
-  std::vector<std::string> m_positionals;
-
-  std::string m_help_pos {};
-  std::string m_usage_pos {};
-  size_t m_e_pos {0};
-  size_t m_l_pos {0};
-  size_t m_u_pos {0};
-  bool   m_checkp {false};
-  bool   m_bmode {false};
-
-  checker_fn_t c_pchecker {nullptr};
-  setter_fn_t  c_psetter {nullptr};
-};
-
-/**
- * @ingroup Command
- * @brief make a std::shared_ptr<Command>
- *
- * @param name command name
- * @param desc command description
- * @param help command help
- * @return cmd_t
- */
-inline cmd_t make_cmd(const std::string& name,
-                      const std::string& desc,
-                      help_fn_t help = nullptr)
-{
-  return std::make_shared<Command>(Command(name, desc, help));
-}
-
-class Commands;
-/**
- * @ingroup Command
- * @typedef cmds_t
- * @brief Commands constuctor is private, Commands is always used as std::shared_ptr<Commands>
- *
- */
-using cmds_t = std::unique_ptr<Commands>;
-
-class Commands
-{
-  friend cmds_t make_cmds(const std::string&, const std::string&, const std::string&);
-  friend class Parser<1>;
-  friend class Parser<0>;
-
-PRIVATE:
-  Commands(const std::string& name, const std::string& desc, const std::string& version)
-    : m_name(name), m_desc(desc), m_version(version)
-  {}
-
-  void set_help(help_fn_t help)
+  // true if the last freeze indexed the current schema, required by const parses
+  bool frozen() const
   {
-    m_help = help;
+    return m_frozen && schema_size() == m_frozen_size &&
+           conf::get().m_abbreviations == m_frozen_abbreviations;
   }
 
-  cmd_t get(const std::string& name)
+  void show_version()
   {
-    return m_cmds.at(name);
+    std::cerr << m_name << " " << m_version << std::endl;
   }
 
-  bool exists(const std::string& name)
+  std::vector<param::cmd_t> commands() const
   {
-    return m_cmds.count(name) > 0;
+    if constexpr(Mode == 0)
+      return {m_current_cmd};
+    else
+      return m_cmds->m_order;
   }
 
-  std::vector<std::string> list()
+  param::param_t get_bound(const std::string& pname) const
   {
-    std::vector<std::string> ret;
-    for (auto& c : m_order)
-      ret.push_back(c->name());
-    return ret;
+    param::param_t p = getp(pname);
+    if (!p)
+      BCLI_THROW(ex::UnknownParamError(pname + " is bound but doesn't exist."));
+    return p;
   }
 
-  std::string get_help()
+  /**
+   * Per-parse context. Without result, the parse state is stored in params and
+   * commands (legacy mode), otherwise in the result.
+   */
+  struct Ctx
   {
-    if (m_help)
-      return m_help();
+    param::Command* cmd {nullptr};
+    param::cmd_t*   select {nullptr};
+    Result*         result {nullptr};
+    std::vector<ex::BCliError>* errors {nullptr};
+    std::string     current {};
+    param::Param*   param {nullptr};
+    bool            is_param {false};
+    bool            end_of_options {false};
+    std::deque<Token>* tokens {nullptr};
+    std::deque<std::string>* owned {nullptr};
+    std::istream*   input {nullptr};
+    std::vector<uint8_t> checked {}; // positionals already checked by an expansion
+    bool            last_is_flag {false};
+    bool            bypass {false};
+  };
+
+  // throw, or collect usage errors when parsing with try_parse
+  template<typename E>
+  void fail(Ctx& ctx, const std::string& msg) const
+  {
+    if (ctx.errors)
+      ctx.errors->push_back(E(msg));
     else
-    {
-      size_t pad = (*std::max_element(m_order.begin(), m_order.end(), [](cmd_t a, cmd_t b) -> bool {
-          return a->name().size() < b->name().size();
-      }))->name().size();
-      std::stringstream help;
-      help << m_name << " " << m_version << "\n\n";
-      help << "DESCRIPTION" << "\n" << utils::sp(2) << m_desc << "\n\n";
-      help << "USAGE" << "\n" << utils::sp(2);
-      help << m_name << " " << utils::wrap(utils::join(list(), "|"), "[]") << "\n\n";
-      help << "COMMANDS" << "\n";
-      for (auto& cmd: m_order)
-      {
-        help << utils::sp(2) << std::setw(pad) << std::left << cmd->name() << " - " << cmd->desc() << "\n";
-      }
-      return help.str();
-    }
+      BCLI_THROW(E(msg));
   }
 
-  void add(cmd_t c)
+  void fail_if(Ctx& ctx, const check::checker_ret_t& rc) const
   {
-    m_cmds.insert({c->name(), c});
-    m_order.push_back(c);
+    if (!std::get<0>(rc))
+      fail<ex::CheckFailedError>(ctx, std::get<1>(rc));
   }
 
-PRIVATE:
-  std::string m_name;
-  std::string m_desc;
-  std::string m_version;
-  std::unordered_map<std::string, cmd_t> m_cmds;
-  std::vector<cmd_t>                     m_order;
-  help_fn_t                              m_help {nullptr};
-};
-
-inline cmds_t make_cmds(const std::string& name,
-                        const std::string& desc,
-                        const std::string& version)
-{
-  return std::make_unique<Commands>(Commands(name, desc, version));
-}
-
-} // end of namespace param
+public:
+  /**
+   * @ingroup Parser
+   * @brief Tokens, see Parser::tokens
+   */
+  class Tokens
+  {
+    friend class Parser;
 
-/**
- * @defgroup Parser
- * @brief About bcli parser.
- *
- */
+  public:
+    class iterator
+    {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = Token;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const Token*;
+      using reference = const Token&;
+
+      explicit iterator(Tokens* tokens = nullptr) : m_tokens(tokens)
+      {
+        if (m_tokens && !m_tokens->next())
+          m_tokens = nullptr;
+      }
 
-using pgroup_t = param::pgroup_t;
-using param_t  = param::param_t;
-using cmd_t    = param::cmd_t;
-using conf     = config::Config;
+      const Token& operator*() const { return m_tokens->m_current; }
+      const Token* operator->() const { return &m_tokens->m_current; }
 
-#define ENABLE_IF(n)                                               \
-template<int M = Mode,                                             \
-         typename = typename std::enable_if<M == n, void>::type>   \
+      iterator& operator++()
+      {
+        if (!m_tokens->next())
+          m_tokens = nullptr;
+        return *this;
+      }
 
-#define ENABLE_IF_P(n, pack)                                       \
-template<pack,                                                     \
-         int M = Mode,                                             \
-         typename = typename std::enable_if<M == n, void>::type>   \
+      bool operator==(const iterator& other) const { return m_tokens == other.m_tokens; }
+      bool operator!=(const iterator& other) const { return m_tokens != other.m_tokens; }
 
-#define BCLI_PARSE(parser, argc, argv) \
-try {                                  \
-  parser.parse(argc, argv);            \
-} catch (const bc::ex::BCliError& e) { \
-  bc::utils::exit_bcli(e);             \
-  exit(EXIT_FAILURE);                  \
-}                                      \
+    PRIVATE:
+      Tokens* m_tokens {nullptr};
+    };
 
-/**
- * @ingroup Parser
- * @brief bcli parser
- *
- * @tparam Mode 0: classical, 1: multiple commands
- */
-template<int Mode = 0>
-class Parser
-{
-public:
-  Parser(const std::string& name,
-         const std::string& desc,
-         const std::string& version,
-         const std::string& authors = {})
-    : m_name(name), m_desc(desc), m_version(version), m_authors(authors)
-  {
-    m_current_cmd->add(m_current_group);
-  }
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+    /**
+     * @brief next token
+     *
+     * @param token
+     * @return false once argv is exhausted and the final checks are done, or after an
+     *         action (help, version)
+     */
+    bool next(Token& token)
+    {
+      if (!next())
+        return false;
+      token = m_current;
+      return true;
+    }
 
-  /**
-   * @ingroup Parser
-   * @brief parse argv
-   *
-   * @param argc
-   * @param argv
-   */
-  void parse(int argc, char* argv[])
-  {
-    ex::ExHandler::get().check();
+    // the parse context points into this object
+    Tokens(const Tokens&) = delete;
+    Tokens& operator=(const Tokens&) = delete;
+    Tokens(Tokens&&) = delete;
+    Tokens& operator=(Tokens&&) = delete;
 
-    if (!m_is_cmd_mode || m_bypass)
+  PRIVATE:
+    Tokens(const Parser& parser, int argc, char* argv[], Result& result)
+      : m_parser(parser), m_argc(argc), m_argv(argv), m_result(result)
     {
-      for (int i=1; i<argc; i++)
+      // the deadline covers the whole parse, not each step
+      if (m_parser.m_deadline.count() > 0)
+        m_until = check::steady_t::now() + m_parser.m_deadline;
+      m_result.init(m_parser.m_index);
+      if (!m_parser.frozen())
+      {
+        m_result.m_errors.push_back(
+          ex::NotFrozenError("Parser::freeze must be called before Parser::tokens."));
+        m_done = true;
+        return;
+      }
+      m_ctx.cmd = m_parser.m_current_cmd.get();
+      m_ctx.result = &m_result;
+      m_ctx.errors = &m_result.m_errors;
+      m_ctx.tokens = &m_pending;
+      m_ctx.owned = &m_owned;
+      m_result.m_cmd_name = m_ctx.cmd->name();
+      m_result.m_cmd = m_ctx.cmd;
+      if (m_parser.m_is_cmd_mode)
       {
-        switch (process_arg(argv[i]))
+        if (m_argc < 2)
         {
-        case Action::ShowHelp:
-          show_help();
-          throw ex::BCliError("", "", ex::ExitCodes::Failure);
-        case Action::ShowVersion:
-          show_version();
-          throw ex::BCliError("", "", ex::ExitCodes::Failure);
-        default: break;
+          m_result.m_action = Action::ShowHelp;
+          m_done = true;
         }
+        else if (!m_parser.select_cmd(m_ctx, m_argv[1]))
+          m_done = true;
+        else
+          m_index = 2;
+        m_result.m_cmd_name = m_ctx.cmd->name();
+        m_result.m_cmd = m_ctx.cmd;
       }
-      if (m_is_param)
-        throw ex::MissingValueError(m_current + " needs a value.");
-      check_consistency();
     }
-    else
+
+    bool next()
     {
-      if (argc < 2)
+      check::Deadline deadline(m_until);
+#if BCLI_EXCEPTIONS
+      try
+      {
+#endif
+        while (m_pending.empty() && !m_done)
+          step();
+#if BCLI_EXCEPTIONS
+      }
+      catch (const ex::BCliError& e)
       {
-        show_help();
-        throw ex::BCliError("", "", ex::ExitCodes::Failure);
+        m_result.m_errors.push_back(e);
+        m_done = true;
       }
-      if (m_cmds->exists(argv[1]))
+#endif
+      if (m_pending.empty())
+        return false;
+      m_current = m_pending.front();
+      m_pending.pop_front();
+      return true;
+    }
+
+    void step()
+    {
+      m_owned.clear();
+      if (m_ctx.input)
+        m_parser.read_positional(m_ctx, m_line);
+      else if (m_index < m_argc)
       {
-        m_current_cmd = m_cmds->get(argv[1]);
-        m_bypass = true;
-        parse(argc-1, argv+1);
+        Action action = m_parser.process_arg(m_ctx, m_argv[m_index++]);
+        if (action != Action::Nothing)
+        {
+          m_result.m_action = action;
+          m_done = true;
+        }
       }
       else
       {
-        std::stringstream ss;
-        ss << "Unknown command: " << argv[1] << ", ";
-        ss << "choices -> "<< utils::wrap(utils::join(m_cmds->list(), "|"), "[]");
-        throw ex::UnknownCmdError(ss.str());
+        if (m_ctx.is_param)
+          m_parser.template fail<ex::MissingValueError>(m_ctx, m_ctx.current + " needs a value.");
+        m_parser.check_consistency(m_ctx);
+        m_done = true;
       }
     }
-  }
 
-public:
-  /**
-   * @ingroup Parser
-   * @brief add commmand
-   *
-   * @param name command name
-   * @param desc command description
-   * @param help command help
-   * @return param::cmd_t
-   */
-  ENABLE_IF(1)
-  param::cmd_t add_command(const std::string& name,
-                     const std::string& desc,
-                     param::help_fn_t help = nullptr)
-  {
-    param::cmd_t cmd = param::make_cmd(name, desc, help);
-    m_current_cmd = cmd;
-    m_current_cmd->add(param::make_group(conf::get().m_default_grp, ""));
-    m_cmds->add(cmd);
-    m_is_cmd_mode = true;
-    return cmd;
+  PRIVATE:
+    const Parser&     m_parser;
+    int               m_argc;
+    char**            m_argv;
+    Result&           m_result;
+    Ctx               m_ctx {};
+    std::deque<Token> m_pending {};
+    Token             m_current {};
+    std::string       m_line {};
+    std::deque<std::string> m_owned {};
+    int               m_index {1};
+    bool              m_done {false};
+    std::optional<check::steady_t::time_point> m_until {};
+  };
+
+PRIVATE:
+
+  param::State& state(Ctx& ctx, param::Param& p) const
+  {
+    if (!ctx.result)
+      return p;
+    if (p.id() >= ctx.result->m_states.size())
+      BCLI_THROW(ex::NotFrozenError(p.raw() + " was added after Parser::freeze."));
+    return ctx.result->m_states[p.id()];
   }
 
-  ENABLE_IF(1)
-  bool is(const std::string& cmd_name)
+  // next line of the positionals stream, false at the end
+  bool read_positional(Ctx& ctx, std::string& line) const
   {
-    return (cmd_name == m_current_cmd->name());
+    while (std::getline(*ctx.input, line))
+    {
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if (line.empty())
+        continue;
+      push_positionals(ctx, line);
+      return true;
+    }
+    ctx.input = nullptr;
+    return false;
   }
 
-  /**
-   * @ingroup Parser
-   * @brief add group
-   *
-   * @param name group name
-   * @param desc group description
-   * @return param::pgroup_t
-   */
-  ENABLE_IF(0)
-  param::pgroup_t add_group(const std::string& name,
-                            const std::string& desc)
+  // views of the yielded tokens stay valid until the next step of Parser::tokens
+  void push_positionals(Ctx& ctx, std::string_view arg) const
   {
-    if (m_current_group != m_current_cmd->get(m_current_group->name()))
-      m_current_cmd->add(m_current_group);
-    m_current_group = param::make_group(name, desc);
-    m_current_cmd->add(m_current_group);
-    return m_current_group;
+    std::string value(arg);
+    ctx.cmd->expand_positional(value, [&](const std::string& p, bool checked) {
+      if (ctx.cmd->m_expand)
+        ctx.checked.push_back(checked);
+      if (ctx.result)
+        ctx.result->m_positionals.push_back(p);
+      else
+        ctx.cmd->push_positionals(p);
+      if (ctx.tokens)
+        ctx.tokens->push_back({Token::Kind::Positional, handle_t{},
+                               &p == &value ? arg : ctx.owned->emplace_back(p)});
+    });
   }
 
-  /**
-   * @ingroup Parser
-   * @brief add common
-   *
-   * @param name name
-   * @return param::pgroup_t
-   */
-  ENABLE_IF(0)
-  param::pgroup_t add_common(const std::string& name = "common")
+  Action parse(Ctx& ctx, int argc, char* argv[]) const
   {
-    m_current_cmd->add_common(name);
-    m_current_group = m_current_cmd->get(name);
-    return m_current_group;
+    check::Deadline deadline(m_deadline);
+    if (!m_is_cmd_mode || ctx.bypass)
+    {
+      for (int i=1; i<argc; i++)
+      {
+        Action action = process_arg(ctx, argv[i]);
+        if (action != Action::Nothing)
+          return action;
+      }
+      if (ctx.is_param)
+      {
+        fail<ex::MissingValueError>(ctx, ctx.current + " needs a value.");
+        ctx.is_param = false;
+      }
+      check_consistency(ctx);
+    }
+    else
+    {
+      if (argc < 2)
+        return Action::ShowHelp;
+      if (select_cmd(ctx, argv[1]))
+        return parse(ctx, argc-1, argv+1);
+    }
+    return Action::Nothing;
   }
 
-  /**
-   * @ingroup Parser
-   * @brief add param
-   *
-   * @param name param name
-   * @param help param help
-   * @return param::param_t
-   */
-  ENABLE_IF(0)
-  param::param_t add_param(const std::string& name,
-                           const std::string& help)
+  bool select_cmd(Ctx& ctx, const std::string& name) const
   {
-    param::param_t p = param::make(name, help);
-    m_current_group->add(p);
-    return p;
+    if (m_cmds->exists(name))
+    {
+      ctx.cmd = m_cmds->m_cmds.at(name).get();
+      if (ctx.select)
+        *ctx.select = m_cmds->get(name);
+      ctx.bypass = true;
+      return true;
+    }
+    std::stringstream ss;
+    ss << "Unknown command: " << name << ", ";
+    auto near = m_frozen ? m_cmds->m_names.suggest(name) : m_cmds->names().suggest(name);
+    if (!near.empty())
+      ss << "did you mean " << utils::join(near, " or ") << "?";
+    else
+      ss << "choices -> "<< utils::wrap(utils::join(m_cmds->list(), "|"), "[]");
+    fail<ex::UnknownCmdError>(ctx, ss.str());
+    return false;
   }
 
-  /**
-   * @ingroup Parser
-   * @brief get positional arguments
-   *
-   * @return const std::vector<std::string>&
-   */
-  const std::vector<std::string>& get_positionals() const
+  // lookup by name without dashes, without allocation once frozen
+  param::Param* find_param(const Ctx& ctx, std::string_view name) const
   {
-    return m_current_cmd->get_positionals();
+    if (m_frozen)
+    {
+      auto it = ctx.cmd->m_lookup.find(name);
+      return it == ctx.cmd->m_lookup.end() ? nullptr : it->second;
+    }
+    return get_current_param(ctx, std::string(name));
   }
 
-  /**
-   * @ingroup Parser
-   * @brief set number of positionals
-   *
-   * @param nb number of positionals
-   * @param usage positionals usage
-   * @param help positionals help
-   */
-  ENABLE_IF(0)
-  void set_positionals(size_t nb, const std::string& usage, const std::string& help)
+  // name of a long param, resolving abbreviations, nullptr if unknown or ambiguous
+  param::Param* find_long(Ctx& ctx, std::string_view arg, std::string_view name,
+                          bool& ambiguous) const
   {
-    m_current_cmd->set_positionals(nb, usage, help);
+    if (param::Param* cp = find_param(ctx, name))
+      return cp;
+    if (!conf::get().m_abbreviations)
+      return nullptr;
+    auto full = m_frozen ? ctx.cmd->m_long_names.complete(name)
+                         : ctx.cmd->long_names().complete(name);
+    if (full.size() == 1)
+      return find_param(ctx, full[0]);
+    ambiguous = full.size() > 1;
+    if (ambiguous)
+      fail<ex::AmbiguousParamError>(ctx, "Ambiguous param: " + std::string(arg) +
+        ", candidates -> " + utils::wrap(utils::join(full, "|", [](const std::string& s) {
+          return "--" + s;
+        }), "[]"));
+    return nullptr;
   }
 
-  /**
-   * @ingroup Parser
-   * @brief set positional bounds
-   *
-   * @param min min number of positionals
-   * @param max max number of positionals
-   * @param usage positionals usage
-   * @param help positionals help
-   */
-  ENABLE_IF(0)
-  void set_positional_bounds(size_t min, size_t max,
-                             const std::string& usage,
-                             const std::string& help)
+  void unknown_param(Ctx& ctx, std::string_view arg) const
   {
-    m_current_cmd->set_positional_bounds(min, max, usage, help);
+    std::string name(arg);
+    auto near = m_frozen ? ctx.cmd->m_names.suggest(name) : ctx.cmd->names().suggest(name);
+    if (near.empty())
+      fail<ex::InvalidParamError>(ctx, "Unknown param: " + name + ".");
+    else
+      fail<ex::InvalidParamError>(ctx, "Unknown param: " + name + ", did you mean " +
+                                       utils::join(near, " or ") + "?");
   }
 
-  /**
-   * @ingroup Parser
-   * @brief set positionals usage and help
-   *
-   * @param usage positionals usage
-   * @param help positionals help
-   */
-  ENABLE_IF(0)
-  void set_positionals_help(const std::string& usage, const std::string& help)
+  bool is_option(const Ctx& ctx, std::string_view arg) const
   {
-    m_current_cmd->set_positionals_help(usage, help);
+    if (ctx.end_of_options || arg.size() < 2 || arg[0] != '-')
+      return false;
+    if (arg[1] == '-')
+      return true;
+    // -5, -0.1: a negative number, unless a param has this name. -inf and -nan are
+    // options, as bundles of short flags
+    double d;
+    if (!std::isdigit(static_cast<unsigned char>(arg[1])) && arg[1] != '.')
+      return true;
+    return !utils::try_from_string(arg, d) || find_param(ctx, arg.substr(1));
   }
 
-  /**
-   * @ingroup Parser
-   * @brief set positionals checker
-   *
-   * @param checker
-   */
-  ENABLE_IF(0)
-  void positionals_checker(check::checker_fn_t checker)
+  void process_value(Ctx& ctx, std::string_view arg) const
   {
-    m_current_cmd->positionals_checker(checker);
+    bool apply = !ctx.result;
+    if (arg.size() > 2 && arg.substr(0, 2) == "[-" && arg.back() == ']')
+      arg = arg.substr(1, arg.size() - 2);
+    auto rc = ctx.param->process(state(ctx, *ctx.param), std::string(arg), apply);
+    fail_if(ctx, rc);
+    if (ctx.tokens && std::get<0>(rc))
+      ctx.tokens->push_back({Token::Kind::Param, handle_t{ctx.param->id()}, arg});
+    ctx.is_param = false;
   }
 
-  /**
-   * @ingroup Parser
-   * @brief set help
-   *
-   * @param help
-   */
-  void set_help(std::function<std::string()> help)
+  // a param, with its value if attached (--k=31, -k31)
+  Action process_param(Ctx& ctx, param::Param* cp, std::string_view name,
+                       std::optional<std::string_view> value) const
   {
-    if constexpr(Mode == 0)
-      m_current_cmd->set_help(help);
+    if (ctx.is_param)
+      fail<ex::MissingValueError>(ctx, ctx.current + " needs a value.");
+    ctx.current = name;
+    ctx.param = cp;
+    ctx.is_param = false;
+    if (cp->is_flag())
+    {
+      if (value)
+      {
+        fail<ex::InvalidParamError>(ctx, ctx.current + " is a flag, it doesn't take a value.");
+        return Action::Nothing;
+      }
+      ctx.last_is_flag = true;
+      param::State& st = state(ctx, *cp);
+      cp->set(st);
+      auto rc = cp->process(st, FLAG_VALUE, !ctx.result);
+      fail_if(ctx, rc);
+      if (ctx.tokens && std::get<0>(rc))
+        ctx.tokens->push_back({Token::Kind::Param, handle_t{cp->id()}, {}});
+    }
+    else if (value)
+      process_value(ctx, *value);
     else
-      m_cmds->set_help(help);
+      ctx.is_param = true;
+    return cp->get_action();
   }
 
-  /**
-   * @ingroup Parser
-   * @brief get param
-   *
-   * For "-p/--param":
-   * @code
-   * cli->getp("p");
-   * cli->getp("-p");
-   * cli->getp("param");
-   * cli->getp("--param");
-   * @endcode
-   * @param pname param name
-   * @return param_t
+  /*
+   * Tokens:
+   *   --name, --name=value    long param (or unique prefix, see conf abbreviations)
+   *   -n, -nvalue, -n=value   short param
+   *   -vd                     bundled short flags, the last one may take a value (-vdk31)
+   *   --                      end of options, next tokens are positionals
+   *   -, -5, -0.1             values
    */
-  param_t getp(const std::string& pname) const
+  Action process_arg(Ctx& ctx, std::string_view arg) const
   {
-    std::string pname_ = utils::trim_param(pname);
-    for (auto& group : *m_current_cmd)
+    if (ctx.cmd->m_pos_stream && !ctx.is_param && !ctx.end_of_options &&
+        (arg == "-" || arg == "--inputs-from-stdin"))
     {
-      if (group->exists(pname_))
-        return group->get(pname_);
+      ctx.input = ctx.cmd->m_pos_stream;
+      // Parser::tokens reads one line per step
+      std::string line;
+      while (!ctx.tokens && read_positional(ctx, line));
+      return Action::Nothing;
     }
-    return nullptr;
-  }
 
-  void show_help()
-  {
-    if (!m_is_cmd_mode || m_bypass)
+    if (!is_option(ctx, arg))
     {
-      std::cerr << m_current_cmd->get_help(m_name, m_version, m_bypass) << std::endl;
+      if (ctx.is_param)
+        process_value(ctx, arg);
+      else
+        push_positionals(ctx, arg);
+      return Action::Nothing;
     }
-    else
+
+    if (arg[1] == '-')
     {
-      std::cerr << m_cmds->get_help() << std::endl;
+      if (arg.size() == 2)
+      {
+        if (ctx.is_param)
+        {
+          fail<ex::MissingValueError>(ctx, ctx.current + " needs a value.");
+          ctx.is_param = false;
+        }
+        ctx.end_of_options = true;
+        return Action::Nothing;
+      }
+      size_t eq = arg.find('=');
+      std::string_view name = arg.substr(0, eq);
+      std::optional<std::string_view> value;
+      if (eq != std::string_view::npos)
+        value = arg.substr(eq + 1);
+      bool ambiguous = false;
+      param::Param* cp = find_long(ctx, arg, name.substr(2), ambiguous);
+      if (!cp)
+      {
+        if (!ambiguous)
+          unknown_param(ctx, name);
+        ctx.is_param = false;
+        return Action::Nothing;
+      }
+      return process_param(ctx, cp, name, value);
+    }
+
+    if (param::Param* cp = find_param(ctx, arg.substr(1)))
+      return process_param(ctx, cp, arg, std::nullopt);
+
+    // bundle, ex: -vd, -k31, -vk=31
+    for (size_t i=1; i<arg.size(); i++)
+    {
+      param::Param* cp = find_param(ctx, arg.substr(i, 1));
+      if (!cp)
+      {
+        unknown_param(ctx, arg);
+        ctx.is_param = false;
+        return Action::Nothing;
+      }
+      std::string name {'-', arg[i]};
+      if (cp->is_flag())
+      {
+        Action action = process_param(ctx, cp, name, std::nullopt);
+        if (action != Action::Nothing)
+          return action;
+        continue;
+      }
+      std::optional<std::string_view> value;
+      if (i + 1 < arg.size())
+        value = arg.substr(arg[i + 1] == '=' ? i + 2 : i + 1);
+      return process_param(ctx, cp, name, value);
     }
+    return Action::Nothing;
   }
 
-PRIVATE:
-  void show_version()
+  param::Param* get_current_param(const Ctx& ctx, const std::string& p) const
   {
-    std::cerr << m_name << " " << m_version << std::endl;
+    std::string pname = utils::trim_param(p);
+    for (auto& group: *ctx.cmd)
+      if (group->exists(pname))
+        return group->m_params.at(pname).get();
+    return nullptr;
   }
 
-  bool pexists(const std::string& pname) const
+  void fail_constraint(Ctx& ctx, param::Constraints::Kind kind, const std::string& msg) const
   {
-    for (auto& group : *m_current_cmd)
+    using Kind = param::Constraints::Kind;
+    switch (kind)
     {
-      if (group->exists(pname))
-        return true;
+    case Kind::Depends: fail<ex::DependsError>(ctx, msg); break;
+    case Kind::Banned: fail<ex::BannedError>(ctx, msg); break;
+    case Kind::Exclusive: fail<ex::IncompatibleError>(ctx, msg); break;
+    case Kind::AtLeastOne: fail<ex::RequiredParamError>(ctx, msg); break;
+    case Kind::Relation: fail<ex::RelationError>(ctx, msg); break;
     }
-    return false;
   }
 
-  Action process_arg(const std::string& arg)
+  using violations_t = std::vector<std::tuple<param::Constraints::Kind, std::string>>;
+
+  violations_t eval_constraints(Ctx& ctx, const param::Param* only = nullptr) const
+  {
+    violations_t violations;
+    ctx.cmd->m_constraints.eval(
+      [&](param::Param& p) -> const param::State& { return state(ctx, p); },
+      [&](param::Constraints::Kind kind, std::string msg) {
+        violations.emplace_back(kind, std::move(msg));
+      },
+      only);
+    return violations;
+  }
+
+  // all violations are reported at once, when throwing, the error type is the one
+  // of the first violation
+  void report_constraints(Ctx& ctx, const violations_t& violations) const
   {
-    if (utils::is_param(arg))
+    if (violations.empty())
+      return;
+    if (ctx.errors)
     {
-      if (!pexists(arg))
-        throw ex::InvalidParamError("Unknown param: " + arg + ".");
-      else if (m_is_param)
-        throw ex::MissingValueError(m_current + "needs a value.");
-      m_current = arg;
-      m_is_param = true;
+      for (auto& [kind, msg] : violations)
+        fail_constraint(ctx, kind, msg);
+      return;
+    }
+    std::vector<std::string> msgs;
+    for (auto& v : violations)
+      msgs.push_back(std::get<1>(v));
+    fail_constraint(ctx, std::get<0>(violations.front()), utils::join(msgs, "\n"));
+  }
 
-      param::param_t cp = get_current_param(m_current);
-      if (cp->is_flag())
+  void update(Ctx& ctx, param::Param& p, const std::string& value) const
+  {
+    if (!ctx.cmd)
+      BCLI_THROW(ex::NotFrozenError("A parse must be done before Parser::update."));
+    check::Deadline deadline(m_deadline);
+    if (!std::any_of(ctx.cmd->begin(), ctx.cmd->end(), [&p](const param::pgroup_t& g) {
+      return std::any_of(g->begin(), g->end(), [&p](const param::param_t& q) {
+        return q.get() == &p;
+      });
+    }))
+      BCLI_THROW(ex::UnknownParamError(p.raw() + " doesn't belong to the parsed command."));
+
+    param::State& st = state(ctx, p);
+    param::State previous = st;
+    st.m_as_default = false;
+    st.m_has_valid_value = false;
+
+    check::checker_ret_t rc {true, ""};
+    if (p.is_flag())
+    {
+      if (value.empty() || value == "0" || value == "false")
+        st.reset(p.get_def());
+      else
       {
-        m_is_param = false;
-        m_last_is_flag = true;
-        cp->set();
-        get_current_param(m_current)->process(FLAG_VALUE);
+        p.set(st);
+        rc = p.process(st, FLAG_VALUE, false);
       }
-
-      if (cp->get_action() != Action::Nothing) return cp->get_action();
     }
-    else if (!m_is_param)
+    else if (p.is_multi())
     {
-      m_current_cmd->push_positionals(arg);
+      st.m_str_values.clear();
+      st.m_checked.clear();
+      p.process(st, value, false);
+      rc = p.process_multi(st, false);
     }
-    else if (m_is_param)
+    else
+      rc = p.process(st, value, false);
+
+    if (!std::get<0>(rc))
     {
-      std::string parg;
-      if (utils::startswith(arg, "[-") && utils::endswith(arg, "]"))
-        parg = utils::unwrap(arg, 1);
-      else
-        parg = arg;
-      get_current_param(m_current)->process(parg);
-      m_is_param = false;
+      st = std::move(previous);
+      BCLI_THROW(ex::CheckFailedError(std::get<1>(rc)));
     }
-    return Action::Nothing;
+
+    if (violations_t violations = eval_constraints(ctx, &p); !violations.empty())
+    {
+      st = std::move(previous);
+      report_constraints(ctx, violations);
+      return;
+    }
+
+    if (!ctx.result)
+      p.apply(st);
   }
 
-  param::param_t get_current_param(const std::string& p) const
+  // drop or report files given twice, before multi-value params are processed
+  void dedup_inputs(Ctx& ctx) const
   {
-    std::string pname = utils::trim_param(p);
-    for (auto& group: *m_current_cmd)
-      if (group->exists(pname))
-        return group->get(pname);
-    return nullptr;
+    if (!ctx.cmd->m_dedup)
+      return;
+    bool drop = *ctx.cmd->m_dedup == param::Dedup::Drop;
+    utils::FrontCodedStore& positionals = ctx.result ? ctx.result->m_positionals
+                                                     : ctx.cmd->m_positionals;
+
+    // positionals then values, in the order they are visited below
+    auto paths = std::make_shared<std::vector<std::string>>();
+    paths->reserve(positionals.size());
+    for (auto& path : positionals)
+      paths->push_back(path);
+    for (auto& p : ctx.cmd->m_dedup_params)
+      for (auto& v : state(ctx, *p).m_str_values)
+        paths->push_back(v);
+
+    // stat may hang on a stale mount, it runs under the parse deadline as checkers do
+    using ids_t = std::vector<std::optional<utils::FileId>>;
+    auto stat_all = [paths]() {
+      ids_t ids(paths->size());
+      for (size_t i=0; i<paths->size(); i++)
+        if (utils::FileId id; utils::file_id((*paths)[i], id))
+          ids[i] = std::move(id);
+      return ids;
+    };
+    auto until = check::parse_deadline();
+    std::optional<ids_t> ids = until ? check::run_until(stat_all, *until) : stat_all();
+    if (!ids)
+    {
+      fail<ex::CheckFailedError>(ctx, "Duplicate input detection timed out, stale mount?");
+      return;
+    }
+
+    std::unordered_map<utils::FileId, size_t, utils::FileId::hash> seen;
+    seen.reserve(paths->size());
+    std::vector<std::string> errors;
+    size_t next = 0;
+
+    // true if the next path must be kept
+    auto keep = [&]() {
+      size_t idx = next++;
+      if (!(*ids)[idx])
+        return true;
+      auto [it, inserted] = seen.emplace(*(*ids)[idx], idx);
+      if (!inserted && !drop)
+        errors.push_back((*paths)[idx] + " is the same file as " + (*paths)[it->second] + ".");
+      return inserted || !drop;
+    };
+
+    utils::FrontCodedStore kept;
+    size_t i = 0, k = 0;
+    for (auto& path : positionals)
+    {
+      if (keep())
+      {
+        kept.push_back(path);
+        if (i < ctx.checked.size())
+          ctx.checked[k] = ctx.checked[i];
+        k++;
+      }
+      i++;
+    }
+    if (ctx.checked.size() > k)
+      ctx.checked.resize(k);
+    if (kept.size() != positionals.size())
+    {
+      positionals = std::move(kept);
+      // the command is shared between concurrent parses into results
+      if (!ctx.result)
+        ctx.cmd->m_nb_pos = positionals.size();
+    }
+
+    for (auto& p : ctx.cmd->m_dedup_params)
+    {
+      param::State& st = state(ctx, *p);
+      size_t n = 0;
+      for (size_t j=0; j<st.m_str_values.size(); j++)
+      {
+        if (!keep())
+          continue;
+        if (j < st.m_checked.size())
+          st.m_checked[n] = st.m_checked[j];
+        if (n != j)
+          st.m_str_values[n] = std::move(st.m_str_values[j]);
+        n++;
+      }
+      st.m_str_values.resize(n);
+      if (st.m_checked.size() > n)
+        st.m_checked.resize(n);
+    }
+
+    if (!errors.empty())
+      fail<ex::DuplicateInputError>(ctx, utils::join(errors, "\n"));
   }
 
-  void check_consistency()
+  void check_consistency(Ctx& ctx) const
   {
-    for (auto& group: *m_current_cmd)
+    bool apply = !ctx.result;
+    dedup_inputs(ctx);
+    for (auto& group: *ctx.cmd)
     {
       for (auto& p : *group)
       {
-        if (p->is_required() && !p->is_set())
-          throw ex::RequiredParamError(p->raw() + " is required.");
-        else if (!p->is_flag() && !p->get_def().empty())
-          p->process_def();
-
-        for (auto& [c, d, dc] : p->get_dependency())
-        {
-          auto [res, msg] = c(p->raw(), p->value());
-          if (!dc)
-          {
-            if (res)
-              if (!d->is_set())
-                throw ex::DependsError(utils::format_depend_errors(p, d, msg));
-          }
-          else
-          {
-            auto [dres, dmsg] = dc(d->raw(), d->value());
-            if (res)
-              if (!dres)
-                throw ex::DependsError(utils::format_depend_errors(p, d, dmsg));
-          }
-        }
-
-        for (auto& [c, d, dc] : p->get_banned())
-        {
-          auto [res, msg] = c(p->raw(), p->value());
-          if (!dc)
-          {
-            if (res)
-              if (d->is_set())
-                throw ex::BannedError(utils::format_banned_errors(p, d, msg));
-          }
-          else
-          {
-            auto [dres, dmsg] = dc(d->raw(), d->value());
-            if (res)
-              if (dres)
-                throw ex::BannedError(utils::format_banned_errors(p, d, dmsg));
-          }
-        }
+        param::State& st = state(ctx, *p);
+        bool provided = !p->is_flag() && p->provide_def(st);
+        if (p->is_required() && !st.m_is_set && !provided)
+          fail<ex::RequiredParamError>(ctx, p->raw() + " is required.");
+        else if (p->is_multi())
+          fail_if(ctx, p->process_multi(st, apply));
+        else if (!p->is_flag() && !st.m_is_set && (provided || !p->get_def().empty()))
+          fail_if(ctx, p->process_def(st, apply, provided));
       }
     }
-    auto [res, msg] = m_current_cmd->check_positionals();
+
+    report_constraints(ctx, eval_constraints(ctx));
+
+    auto [res, msg] = ctx.result ? ctx.cmd->check_positionals(ctx.result->m_positionals, ctx.checked)
+                                 : ctx.cmd->check_positionals(ctx.cmd->m_positionals, ctx.checked);
     if (!res)
-      throw ex::PositionalsError(msg);
-    return;
+      fail<ex::PositionalsError>(ctx, msg);
   }
 
 PRIVATE:
@@ -3181,15 +8478,20 @@ PRIVATE:
   param::cmd_t    m_current_cmd {param::make_cmd(m_name, m_desc)};
   param::cmds_t   m_cmds {param::make_cmds(m_name, m_desc, m_version)};
 
-  std::string m_current {};
+  Ctx m_ctx {};
 
   std::vector<ex::BCliError> m_impl_exceptions {};
   std::vector<ex::BCliError> m_usage_exceptions {};
 
-  bool m_is_param {false};
-  bool m_last_is_flag {false};
   bool m_is_cmd_mode {false};
-  bool m_bypass {false};
+  bool m_frozen {false};
+  size_t m_frozen_size {0};
+  bool m_frozen_abbreviations {false};
+  uint64_t m_freeze_id {0}; // unique per freeze, see bind
+
+  std::chrono::milliseconds m_deadline {0};
+
+  std::vector<param::Param*> m_index {};
 };
 
 } // end of namespace bc
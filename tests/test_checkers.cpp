@@ -124,4 +124,89 @@ TEST(checkers, check_magic)
   EXPECT_TRUE(std::get<0>(check::is_gz("--gz", "./data/test.txt.gz")));
   EXPECT_TRUE(std::get<0>(check::is_lz4_frame("--lz4", "./data/test.txt.lz4")));
   EXPECT_TRUE(std::get<0>(check::is_bz2("--bz2", "./data/test.txt.bz2")));
-}
\ No newline at end of file
+}
+TEST(checkers, range_list)
+{
+  EXPECT_TRUE(std::get<0>(check::f::range_list(15, 63)("--param", "15-31:2,41,51-63")));
+  EXPECT_FALSE(std::get<0>(check::f::range_list(15, 63)("--param", "13-31:2")));
+  EXPECT_FALSE(std::get<0>(check::f::range_list(15, 63)("--param", "15,,16")));
+
+  param::param_t p = param::make("--kmer-sizes", "help");
+  p->checker(check::f::range_list(15, 63));
+  p->process("31,15-21:3");
+  auto ks = p->as<range_list_t<int>>();
+  EXPECT_EQ(ks.values(), std::vector<int>({15, 18, 21, 31}));
+  EXPECT_TRUE(ks.contains(18));
+  EXPECT_FALSE(ks.contains(19));
+  EXPECT_TRUE(ks.bitset()[31]);
+  EXPECT_THROW(p->process("15-"), ex::CheckFailedError);
+}
+
+TEST(checkers, combinators)
+{
+  int reads = 0;
+  check::Checker full_read([&reads](const std::string&, const std::string&) {
+    reads++;
+    return std::make_tuple(true, std::string());
+  }, check::Cost::Full);
+
+  auto gz = check::f::all_of({full_read, check::is_file, check::seems_gz});
+  EXPECT_EQ(gz.cost(), check::Cost::Full);
+  EXPECT_FALSE(std::get<0>(gz("--p", "file.txt")));
+  EXPECT_EQ(reads, 0);
+
+  auto num_or_dna = check::f::any_of({check::is_number, check::is_dna});
+  EXPECT_TRUE(std::get<0>(num_or_dna("--p", "ACGT")));
+  EXPECT_FALSE(std::get<0>(num_or_dna("--p", "xx")));
+
+  auto one = check::f::xor_of({check::is_number, check::f::range(0, 10)});
+  EXPECT_TRUE(std::get<0>(one("--p", "42")));
+  EXPECT_FALSE(std::get<0>(one("--p", "5")));
+
+  auto none = check::f::none_of({check::f::in("a|b"), full_read});
+  EXPECT_FALSE(std::get<0>(none("--p", "a")));
+  EXPECT_EQ(reads, 0);
+
+  param::param_t p = param::make("-p", "help");
+  p->checker(full_read)->checker(check::is_number)->checker_mode(param::CheckerMode::OR);
+  p->process("x");
+  EXPECT_EQ(reads, 1);
+  p->process("10");
+  EXPECT_EQ(reads, 1);
+}
+
+TEST(checkers, timeout)
+{
+  check::Checker stalled([](const std::string&, const std::string&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    return std::make_tuple(true, std::string());
+  }, check::Cost::Stat);
+
+  auto rc = check::f::timeout(stalled, std::chrono::milliseconds(20))("--ref", "/mnt/nfs/ref.fa");
+  EXPECT_FALSE(std::get<0>(rc));
+  EXPECT_NE(std::get<1>(rc).find("/mnt/nfs/ref.fa"), std::string::npos);
+
+  {
+    check::Deadline deadline(std::chrono::milliseconds(20));
+    EXPECT_FALSE(std::get<0>(stalled("--ref", "/mnt/nfs/ref.fa")));
+    EXPECT_TRUE(std::get<0>(check::is_number("--k", "31")));
+  }
+  EXPECT_FALSE(check::parse_deadline());
+
+  // nothing is started once the deadline is passed
+  size_t live = check::live_workers();
+  EXPECT_FALSE(check::run_until([]() { return 1; }, check::steady_t::now()));
+  EXPECT_EQ(check::live_workers(), live);
+  EXPECT_EQ(check::run_until([]() { return 1; },
+                             check::steady_t::now() + std::chrono::seconds(5)), 1);
+}
+
+TEST(checkers, match)
+{
+  auto run = check::f::match("[A-Z0-9]+_L00[1-8]");
+  EXPECT_TRUE(std::get<0>(run("--run", "HWI7_L003")));
+  auto [ok, msg] = run("--run", "HWI7_L009");
+  EXPECT_FALSE(ok);
+  EXPECT_NE(msg.find("HWI7_L009"), std::string::npos);
+  EXPECT_EQ(run.cost(), check::Cost::Pure);
+}
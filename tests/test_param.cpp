@@ -66,6 +66,21 @@ TEST(param, param_checker)
     EXPECT_NO_THROW(p->process("10"));
     EXPECT_TRUE(p->m_has_valid_value);
   }
+  {
+    check::checker_fn_t fn = check::is_number;
+    param::param_t p = param::make("-p/--param", "make test");
+    p->checker(fn)->checker(fn, check::Cost::Pure);
+    ASSERT_EQ(p->c_checkers.size(), 2);
+    EXPECT_EQ(p->c_checkers[0].cost(), check::Cost::Pure);
+    EXPECT_EQ(p->c_checkers[1].cost(), check::Cost::Full);
+    EXPECT_THROW(p->process("ZZ"), ex::CheckFailedError);
+  }
+  {
+    param::param_t p = param::make("-p/--param", "make test");
+    p->checker(check::is_number)->as_flag();
+    EXPECT_THROW(ex::ExHandler::get().throw_last(), ex::BCliError);
+    ex::ExHandler::get().clear();
+  }
 }
 
 TEST(param, param_checker_setter)
@@ -125,4 +140,93 @@ TEST(param, command)
   
   cmd->get("advanced");
   EXPECT_NO_THROW(ex::ExHandler::get().throw_last());
-}
\ No newline at end of file
+}
+TEST(param, from_file)
+{
+  fs::path txt = fs::temp_directory_path() / "bcli_ids.txt";
+  fs::path bin = fs::temp_directory_path() / "bcli_ids.bin";
+  {
+    std::ofstream out(txt);
+    out << "10\n20 30\n\n40,50;60\n";
+    std::vector<double> values = {0.5, 1.5, 2.5};
+    std::ofstream outb(bin, std::ios::binary);
+    outb.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+  }
+  {
+    param::param_t p = param::make("--ids-file", "ids");
+    p->checker(check::is_file)->from_file<uint32_t>();
+    p->process(txt);
+    EXPECT_EQ(p->as<std::vector<uint32_t>>(), std::vector<uint32_t>({10, 20, 30, 40, 50, 60}));
+  }
+  {
+    param::param_t p = param::make("--ids-file", "ids");
+    p->from_file<uint32_t>(FileFormat::Text, 0, 50);
+    EXPECT_THROW(p->process(txt), ex::CheckFailedError);
+  }
+  {
+    param::param_t p = param::make("--ids-file", "ids");
+    p->from_file<double>(FileFormat::Binary);
+    p->process(bin);
+    EXPECT_EQ(p->as<std::vector<double>>(), std::vector<double>({0.5, 1.5, 2.5}));
+  }
+  {
+    param::param_t p = param::make("--ids-file", "ids");
+    p->from_file<uint64_t>(FileFormat::Binary, 0, 10);
+    EXPECT_THROW(p->process(bin), ex::CheckFailedError);
+  }
+  {
+    std::ofstream out(txt);
+    out << "10\n2x0\n";
+  }
+  {
+    param::param_t p = param::make("--ids-file", "ids");
+    p->from_file<uint32_t>();
+    EXPECT_THROW(p->process(txt), ex::CheckFailedError);
+  }
+  fs::remove(txt);
+  fs::remove(bin);
+}
+
+TEST(param, lazy_default)
+{
+  int checks = 0;
+  auto counting = [&checks](const std::string& p, const std::string& v) {
+    checks++;
+    return std::make_tuple(v != "bad", p + " " + v + " is bad.");
+  };
+
+  char* argv[] = {"cmd"};
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-r/--ref", "help")->checker(counting)->def("ref.fa");
+  cli.add_param("-m/--mode", "help")->checker(counting)->def("bad");
+  std::string mode;
+  cli.add_param("-s", "help")->checker(counting)->def("s")->setter(mode);
+
+  cli.parse(1, argv);
+  EXPECT_EQ(checks, 1);
+  EXPECT_EQ(mode, "s");
+
+  EXPECT_EQ(cli.getp("ref")->as<std::string>(), "ref.fa");
+  EXPECT_EQ(cli.getp("ref")->value(), "ref.fa");
+  EXPECT_EQ(checks, 2);
+  EXPECT_THROW(cli.getp("mode")->as<std::string>(), ex::CheckFailedError);
+
+  cli.reparse(1, argv);
+  EXPECT_EQ(cli.getp("ref")->as<std::string>(), "ref.fa");
+  EXPECT_EQ(checks, 3);
+}
+
+TEST(param, values_types)
+{
+  param::param_t p = param::make("-i", "help");
+  p->multi<int>();
+  p->process("1,2,3");
+  p->process_multi(*p, false);
+  const std::vector<int>& a = p->values<int>();
+  const std::vector<std::string>& s = p->values<std::string>();
+  const std::vector<double>& d = p->values<double>();
+  EXPECT_EQ(a, (std::vector<int>{1, 2, 3}));
+  EXPECT_EQ(s, (std::vector<std::string>{"1", "2", "3"}));
+  EXPECT_EQ(d[2], 3.0);
+  EXPECT_EQ(&p->values<int>(), &a);
+}
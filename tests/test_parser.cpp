@@ -64,3 +64,830 @@ TEST(Parser, multiple)
 
   }
 }
+
+TEST(Parser, def_provider)
+{
+  char* argv[] = {"cmd", "-t", "4"};
+  int argc = sizeof(argv)/sizeof(char*);
+
+  setenv("SLURM_CPUS_PER_TASK", "32", 1);
+  setenv("SLURM_MEM_PER_NODE", "64000", 1);
+  unsetenv("SLURM_MEM_PER_CPU");
+  {
+    Parser cli("test", "test", "test", "test");
+    cli.add_param("-c/--nb-cores", "help")->def("8")->def_provider(provider::nb_cores);
+    cli.add_param("-m/--max-memory", "help")->def_provider(provider::memory_per_core);
+    cli.add_param("-t/--threads", "help")->def("1")->def_provider(provider::nb_cores);
+
+    cli.parse(argc, argv);
+    EXPECT_EQ(cli.getp("c")->as<int>(), 32);
+    EXPECT_EQ(cli.getp("m")->as<int>(), 2000);
+    EXPECT_EQ(cli.getp("t")->as<int>(), 4);
+  }
+
+  setenv("SLURM_CPUS_PER_TASK", "2(x3)", 1);
+  unsetenv("SLURM_MEM_PER_NODE");
+  {
+    Parser cli("test", "test", "test", "test");
+    cli.add_param("-c/--nb-cores", "help")->def("8")->def_provider(provider::nb_cores);
+    cli.add_param("-m/--max-memory", "help")->def_provider(provider::memory_per_core);
+
+    EXPECT_THROW(cli.parse(1, argv), ex::RequiredParamError);
+    EXPECT_EQ(cli.getp("c")->as<int>(), 8);
+  }
+  unsetenv("SLURM_CPUS_PER_TASK");
+}
+
+TEST(Parser, multi_values)
+{
+  char* argv[] = {"cmd", "-i", "./data/test.txt", "-k", "21", "-i", "./data/test.txt.gz,./data/test.txt.bz2", "-k", "31,41"};
+  int argc = sizeof(argv)/sizeof(char*);
+  {
+    Parser cli("test", "test", "test", "test");
+    std::vector<int> ks;
+    cli.add_param("-i/--inputs", "help")->multi(4)->checker(check::is_file)->parallel_checks(2);
+    cli.add_param("-k/--kmer-sizes", "help")->multi<int>()->checker(check::is_number)->setter(ks);
+    cli.add_param("-a/--abundances", "help")->multi<int>()->def("1,2");
+
+    cli.parse(argc, argv);
+
+    const std::vector<std::string>& inputs = cli.getp("i")->as<std::vector<std::string>>();
+    EXPECT_EQ(inputs, std::vector<std::string>({"./data/test.txt", "./data/test.txt.gz", "./data/test.txt.bz2"}));
+    EXPECT_EQ(&inputs, &cli.getp("i")->as<std::vector<std::string>>());
+
+    EXPECT_EQ(cli.getp("k")->as<std::vector<int>>(), std::vector<int>({21, 31, 41}));
+    EXPECT_EQ(ks, std::vector<int>({21, 31, 41}));
+    EXPECT_EQ(cli.getp("a")->as<std::vector<int>>(), std::vector<int>({1, 2}));
+  }
+  {
+    char* argv2[] = {"cmd", "-i", "./data/test.txt,./unknown1,./unknown2"};
+    Parser cli("test", "test", "test", "test");
+    cli.add_param("-i/--inputs", "help")->multi()->checker(check::is_file)->parallel_checks();
+    try
+    {
+      cli.parse(3, argv2);
+      FAIL();
+    }
+    catch (const ex::CheckFailedError& e)
+    {
+      EXPECT_TRUE(utils::contains(e.get_msg(), "unknown1"));
+      EXPECT_TRUE(utils::contains(e.get_msg(), "unknown2"));
+    }
+  }
+}
+
+struct BindOptions
+{
+  int k {0};
+  double ratio {0.0};
+  std::string mode;
+  bool lz4 {false};
+  bool keep {true};
+  std::vector<int> abundances;
+};
+
+BCLI_FIELDS(BindOptions,
+  bc::field(&BindOptions::k, "-k/--kmer-size"),
+  bc::field(&BindOptions::ratio, "--ratio"),
+  bc::field(&BindOptions::mode, "-m/--mode"),
+  bc::field(&BindOptions::lz4, "--lz4"),
+  bc::field(&BindOptions::keep, "--keep-tmp"),
+  bc::field(&BindOptions::abundances, "-a"))
+
+TEST(Parser, bind)
+{
+  char* argv[] = {"cmd", "-k", "21", "--lz4", "-a", "2,4"};
+  int argc = sizeof(argv)/sizeof(char*);
+
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-k/--kmer-size", "help")->def("31");
+  cli.add_param("--ratio", "help")->def("0.5");
+  cli.add_param("-m/--mode", "help")->def("bin");
+  cli.add_param("--lz4", "help")->as_flag();
+  cli.add_param("--keep-tmp", "help")->as_flag();
+  cli.add_param("-a", "help")->multi<int>();
+  cli.parse(argc, argv);
+
+  BindOptions opt = cli.bind<BindOptions>();
+  EXPECT_EQ(opt.k, 21);
+  EXPECT_EQ(opt.ratio, 0.5);
+  EXPECT_EQ(opt.mode, "bin");
+  EXPECT_TRUE(opt.lz4);
+  EXPECT_FALSE(opt.keep);
+  EXPECT_EQ(opt.abundances, std::vector<int>({2, 4}));
+
+  // handles are cached per field list, another parser resolves its own
+  char* argv2[] = {"cmd", "-k", "17", "-a", "1"};
+  Parser other("test", "test", "test", "test");
+  other.add_param("-a", "help")->multi<int>();
+  other.add_param("--keep-tmp", "help")->as_flag();
+  other.add_param("--lz4", "help")->as_flag();
+  other.add_param("-m/--mode", "help")->def("ascii");
+  other.add_param("--ratio", "help")->def("0.1");
+  other.add_param("-k/--kmer-size", "help")->def("31");
+  other.parse(5, argv2);
+  EXPECT_EQ(other.bind<BindOptions>().k, 17);
+  EXPECT_EQ(other.bind<BindOptions>().mode, "ascii");
+  EXPECT_EQ(cli.bind<BindOptions>().k, 21);
+  EXPECT_EQ(cli.bind<BindOptions>().mode, "bin");
+
+  BindOptions opt2;
+  EXPECT_THROW(cli.bind(opt2, std::make_tuple(bc::field(&BindOptions::k, "--unknown"))),
+               ex::UnknownParamError);
+}
+
+TEST(Parser, handles)
+{
+  char* argv[] = {"cmd", "-k", "21", "-f", "-i", "1,2"};
+  int argc = sizeof(argv)/sizeof(char*);
+
+  Parser cli("test", "test", "test", "test");
+  handle_t k = cli.handle(cli.add_param("-k/--kmer-size", "help")->def("31"));
+  cli.add_param("-f", "help")->as_flag();
+  cli.add_param("-i", "help")->multi<int>();
+  handle_t f = cli.handle("f");
+
+  cli.add_group("other", "other");
+  cli.add_param("-r/--ratio", "help")->def("0.5");
+  handle_t r = cli.handle("--ratio");
+  handle_t i = cli.handle("i");
+  EXPECT_EQ(cli.handle("k").id, k.id);
+  EXPECT_THROW(cli.handle("unknown"), ex::UnknownParamError);
+  EXPECT_THROW(cli.handle(param::make("-u", "help")), ex::UnknownParamError);
+
+  // indexed in a larger parser, its id is past this parser's index
+  Parser other("other", "other", "other", "other");
+  for (int n=0; n<8; n++)
+    other.add_param("--p" + std::to_string(n), "help")->def("0");
+  param::param_t foreign = other.add_param("--foreign", "help")->def("0");
+  other.handle(foreign);
+  EXPECT_THROW(cli.handle(foreign), ex::UnknownParamError);
+
+  cli.parse(argc, argv);
+  EXPECT_EQ(cli.get<int>(k), 21);
+  EXPECT_EQ(cli.get<std::string>(k), "21");
+  EXPECT_TRUE(cli.get<bool>(f));
+  EXPECT_EQ(cli.get<double>(r), 0.5);
+  EXPECT_EQ(cli.get<std::vector<int>>(i), std::vector<int>({1, 2}));
+  EXPECT_EQ(cli[r].raw(), "-r/--ratio");
+
+  std::vector<std::thread> threads;
+  std::atomic<int> sum {0};
+  for (int t=0; t<4; t++)
+    threads.emplace_back([&]() {
+      for (int n=0; n<1000; n++)
+        sum += cli.get<int>(k);
+    });
+  for (auto& t : threads)
+    t.join();
+  EXPECT_EQ(sum, 4 * 1000 * 21);
+}
+
+TEST(Parser, reparse)
+{
+  char* argv[] = {"cmd", "cmd1", "-p", "10", "-f", "pos1", "pos2", "pos3"};
+  char* argv2[] = {"cmd", "cmd2", "-p", "42", "pos1"};
+  char* argv3[] = {"cmd", "cmd1", "pos1"};
+  int argc = sizeof(argv)/sizeof(char*);
+  int argc2 = sizeof(argv2)/sizeof(char*);
+  int argc3 = sizeof(argv3)/sizeof(char*);
+
+  Parser<1> cli("test", "test", "test", "test");
+  cmd_t cmd1 = cli.add_command("cmd1", "cmd1 desc");
+  cmd1->add_param("-p/--param", "help")->def("1");
+  cmd1->add_param("-f/--flag", "help")->as_flag();
+  cmd_t cmd2 = cli.add_command("cmd2", "cmd2 desc");
+  cmd2->add_param("-p/--param", "help");
+
+  cli.parse(argc, argv);
+  EXPECT_TRUE(cli.is("cmd1"));
+  EXPECT_EQ(cli.getp("p")->as<int>(), 10);
+  EXPECT_EQ(cli.get_positionals().size(), 3);
+
+  cli.reparse(argc2, argv2);
+  EXPECT_TRUE(cli.is("cmd2"));
+  EXPECT_EQ(cli.getp("p")->as<int>(), 42);
+  EXPECT_EQ(cli.get_positionals().size(), 1);
+
+  cli.reparse(argc3, argv3);
+  EXPECT_TRUE(cli.is("cmd1"));
+  EXPECT_EQ(cli.getp("p")->as<int>(), 1);
+  EXPECT_FALSE(cli.getp("f")->is_set());
+  EXPECT_EQ(cli.get_positionals().size(), 1);
+}
+
+TEST(Parser, concurrent_parse)
+{
+  Parser cli("test", "test", "test", "test");
+  handle_t k = cli.handle(cli.add_param("-k/--kmer-size", "help")->def("31")
+                             ->checker(check::f::range(1, 1000)));
+  handle_t f = cli.handle(cli.add_param("-f", "help")->as_flag());
+  handle_t i = cli.handle(cli.add_param("-i", "help")->multi<int>());
+  cli.freeze();
+
+  char* bad[] = {"cmd", "-k", "0"};
+  Result res;
+  EXPECT_THROW(cli.parse(3, bad, res), ex::CheckFailedError);
+
+  std::vector<std::thread> threads;
+  std::atomic<int> errors {0};
+  for (int t=0; t<8; t++)
+    threads.emplace_back([&, t]() {
+      Result r;
+      for (int n=0; n<200; n++)
+      {
+        std::vector<std::string> args {"cmd", "-k", std::to_string(t + n + 1), "-i",
+                                       std::to_string(t) + "," + std::to_string(n), "pos"};
+        if (n % 2)
+          args.push_back("-f");
+        std::vector<char*> argv;
+        for (auto& a : args)
+          argv.push_back(a.data());
+        cli.parse(argv.size(), argv.data(), r);
+        bool ok = r.get<int>(k) == t + n + 1
+                  && r.get<bool>(f) == static_cast<bool>(n % 2)
+                  && r.get<std::vector<int>>(i) == std::vector<int>({t, n})
+                  && r.get_positionals().size() == 1;
+        errors += !ok;
+      }
+    });
+  for (auto& t : threads)
+    t.join();
+  EXPECT_EQ(errors, 0);
+}
+
+TEST(Parser, try_parse)
+{
+  char* argv[] = {"cmd", "-k", "0", "--unknown", "-m", "txt", "-i", "1,a,3"};
+  int argc = sizeof(argv)/sizeof(char*);
+
+  Parser cli("test", "test", "test", "test");
+  handle_t k = cli.handle(cli.add_param("-k/--kmer-size", "help")->def("31")
+                             ->checker(check::f::range(1, 1000)));
+  cli.add_param("-m/--mode", "help")->checker(check::f::in("bin|ascii"));
+  cli.add_param("-i", "help")->multi<int>();
+  cli.add_param("-r", "help");
+
+  // handle() froze the parser, params added since then are not indexed
+  Result unfrozen = cli.try_parse(argc, argv);
+  EXPECT_FALSE(unfrozen.ok());
+  ASSERT_EQ(unfrozen.errors().size(), 1);
+  EXPECT_EQ(unfrozen.errors()[0].get_name(), "NotFrozenError");
+  EXPECT_EQ(unfrozen.errors()[0].get_msg(), "Parser::freeze must be called before try_parse.");
+  cli.freeze();
+
+  Result res = cli.try_parse(argc, argv);
+  EXPECT_FALSE(res);
+  ASSERT_EQ(res.errors().size(), 5);
+  EXPECT_EQ(res.errors()[0].get_name(), "CheckFailedError");
+  EXPECT_NE(res.errors()[0].get_msg().find("Not in range"), std::string::npos);
+  EXPECT_EQ(res.errors()[1].get_name(), "InvalidParamError");
+  EXPECT_EQ(res.errors()[2].get_name(), "CheckFailedError");
+  EXPECT_EQ(res.errors()[3].get_name(), "CheckFailedError");
+  EXPECT_EQ(res.errors()[4].get_name(), "RequiredParamError");
+  EXPECT_EQ(res.exit_code(), ex::ExitCodes::UsageError);
+
+  char* good[] = {"cmd", "-k", "21", "-m", "bin", "-i", "1,2", "-r", "x"};
+  EXPECT_TRUE(cli.try_parse(9, good, res));
+  EXPECT_EQ(res.get<int>(k), 21);
+
+  // out of int range, reported as a failed check
+  char* huge[] = {"cmd", "-k", "99999999999999999999", "-m", "bin", "-i", "1", "-r", "x"};
+  EXPECT_FALSE(cli.try_parse(9, huge, res));
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_name(), "CheckFailedError");
+
+  cli.add_group("late", "late")->add_param("--late", "help")->def("0");
+  EXPECT_FALSE(cli.try_parse(9, good, res));
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_name(), "NotFrozenError");
+}
+
+TEST(Parser, constraints)
+{
+  Parser cli("test", "test", "test", "test");
+  param_t amin = cli.add_param("--abundance-min", "help")->def("2");
+  param_t amax = cli.add_param("--abundance-max", "help")->def("100")
+                    ->relation(param::Rel::Gt, amin);
+  param_t gz = cli.add_param("--gz", "help")->as_flag();
+  param_t lz4 = cli.add_param("--lz4", "help")->as_flag();
+  param_t in = cli.add_param("-i", "help")->def("");
+  param_t in_list = cli.add_param("-l", "help")->def("");
+  cli.add_param("-o", "help")->def("")->depends_on(check::is_number, amin, check::f::range(5, 10));
+  cli.mutually_exclusive({gz, lz4});
+  cli.at_least_one({in, in_list});
+  cli.freeze();
+
+  char* bad[] = {"cmd", "--abundance-min", "50", "--abundance-max", "10", "--gz", "--lz4", "-o", "1"};
+  Result res = cli.try_parse(9, bad);
+  ASSERT_EQ(res.errors().size(), 4);
+  EXPECT_EQ(res.errors()[0].get_name(), "RelationError");
+  EXPECT_EQ(res.errors()[1].get_name(), "DependsError");
+  EXPECT_EQ(res.errors()[2].get_name(), "IncompatibleError");
+  EXPECT_EQ(res.errors()[3].get_name(), "RequiredParamError");
+
+  char* good[] = {"cmd", "--abundance-min", "6", "--gz", "-o", "1", "-l", "list.txt"};
+  EXPECT_TRUE(cli.try_parse(8, good, res));
+
+  try
+  {
+    cli.parse(9, bad);
+    FAIL();
+  }
+  catch (const ex::RelationError& e)
+  {
+    EXPECT_EQ(utils::split(e.get_msg(), '\n').size(), 4);
+  }
+}
+
+TEST(Parser, update)
+{
+  char* argv[] = {"cmd", "-k", "21", "-f", "file.txt", "--min", "2", "--max", "10"};
+  int argc = sizeof(argv)/sizeof(char*);
+
+  int file_checks = 0;
+  auto file_checker = [&file_checks](const std::string&, const std::string&) {
+    file_checks++;
+    return std::make_tuple(true, std::string());
+  };
+
+  int k = 0;
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-k", "help")->checker(check::f::range(1, 32))->setter(k);
+  cli.add_param("-f", "help")->checker(file_checker);
+  param_t min = cli.add_param("--min", "help")->def("0");
+  cli.add_param("--max", "help")->def("100")->relation(param::Rel::Gt, min);
+
+  cli.parse(argc, argv);
+  EXPECT_EQ(file_checks, 1);
+  EXPECT_EQ(k, 21);
+
+  cli.update("k", "25");
+  EXPECT_EQ(k, 25);
+  EXPECT_EQ(cli.getp("k")->as<int>(), 25);
+  EXPECT_THROW(cli.update("k", "64"), ex::CheckFailedError);
+  EXPECT_EQ(cli.getp("k")->as<int>(), 25);
+
+  EXPECT_THROW(cli.update("min", "50"), ex::RelationError);
+  EXPECT_EQ(cli.getp("min")->as<int>(), 2);
+  cli.update("max", "60");
+  cli.update("min", "50");
+  EXPECT_EQ(cli.getp("min")->as<int>(), 50);
+  EXPECT_EQ(file_checks, 1);
+}
+
+TEST(Parser, update_multi_setter)
+{
+  char* argv[] = {"cmd", "-k", "1,2"};
+  std::vector<int> ks;
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-k", "help")->multi()->setter(ks);
+
+  cli.parse(3, argv);
+  EXPECT_EQ(ks, std::vector<int>({1, 2}));
+  cli.update("k", "3");
+  EXPECT_EQ(ks, std::vector<int>({3}));
+}
+
+TEST(Parser, update_unset_flag)
+{
+  char* argv[] = {"cmd", "--fast"};
+  bool fast = false;
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("--fast", "help")->as_flag()->setter(fast);
+
+  cli.parse(2, argv);
+  EXPECT_TRUE(fast);
+  cli.update("fast", "false");
+  EXPECT_FALSE(fast);
+  EXPECT_FALSE(cli.getp("fast")->is_set());
+  cli.update("fast", "1");
+  EXPECT_TRUE(fast);
+}
+
+TEST(Parser, checker_async)
+{
+  std::atomic<bool> release {false};
+  auto slow = [&release](const std::string& p, const std::string& v) {
+    while (!release)
+      std::this_thread::yield();
+    return std::make_tuple(v != "corrupted.idx", p + " " + v + " is corrupted.");
+  };
+
+  char* argv[] = {"cmd", "-i", "ok.idx", "-j", "corrupted.idx"};
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-i", "help")->checker_async(slow);
+  cli.add_param("-j", "help")->checker_async(slow);
+
+  cli.parse(5, argv);
+  release = true;
+  EXPECT_EQ(cli.getp("i")->as<std::string>(), "ok.idx");
+  EXPECT_THROW(cli.getp("j")->as<std::string>(), ex::CheckFailedError);
+  EXPECT_THROW(cli.sync(), ex::CheckFailedError);
+
+  cli.freeze();
+  release = false;
+  Result res;
+  EXPECT_TRUE(cli.try_parse(5, argv, res));
+  release = true;
+  EXPECT_FALSE(res.sync());
+  EXPECT_EQ(res.errors().size(), 1);
+}
+
+TEST(Parser, deadline_parallel_checks)
+{
+  std::string values = "a";
+  for (int i=1; i<64; i++)
+    values += ",a";
+  char* argv[] = {"cmd", "-r", values.data()};
+  check::Checker stalled([](const std::string&, const std::string&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    return std::make_tuple(true, std::string());
+  }, check::Cost::Stat);
+
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-r", "help")->multi()->checker(stalled)->parallel_checks(4);
+  cli.set_deadline(std::chrono::milliseconds(20));
+  cli.freeze();
+
+  auto start = std::chrono::steady_clock::now();
+  Result res = cli.try_parse(3, argv);
+  EXPECT_FALSE(res.errors().empty());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+}
+
+TEST(Parser, deadline_tokens)
+{
+  char* argv[] = {"cmd", "-a", "x", "-b", "x", "-c", "x", "-d", "x"};
+  check::Checker stalled([](const std::string&, const std::string&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    return std::make_tuple(true, std::string());
+  }, check::Cost::Stat);
+
+  Parser cli("test", "test", "test", "test");
+  for (auto name : {"-a", "-b", "-c", "-d"})
+    cli.add_param(name, "help")->checker(stalled);
+  cli.set_deadline(std::chrono::milliseconds(50));
+  cli.freeze();
+
+  // one deadline for the whole parse, not one per token
+  auto start = std::chrono::steady_clock::now();
+  Result res;
+  for (const Token& t : cli.tokens(9, argv, res))
+    (void)t;
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+  EXPECT_EQ(res.errors().size(), 4);
+}
+
+TEST(Parser, freeze_after_schema_change)
+{
+  char* argv[] = {"cmd", "-a", "1", "-b", "2", "-c", "3"};
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-a", "help")->def("");
+  cli.freeze();
+  cli.freeze();
+
+  Result res = cli.try_parse(3, argv);
+  EXPECT_TRUE(res.errors().empty());
+
+  cli.add_param("-b", "help")->def("");
+  res = cli.try_parse(5, argv);
+  ASSERT_FALSE(res.errors().empty());
+  EXPECT_NE(res.errors()[0].get_msg().find("Parser::freeze"), std::string::npos);
+
+  // added through the group, the parser isn't told
+  param::pgroup_t group = cli.add_group("other", "");
+  group->add_param("-c", "help")->def("");
+  cli.parse(7, argv);
+  EXPECT_EQ(cli.getp("b")->as<int>(), 2);
+  EXPECT_EQ(cli.getp("c")->as<int>(), 3);
+}
+
+TEST(Parser, checker_async_no_wait)
+{
+  // a value given twice, a reparse and a new result drop pending checks without waiting
+  char* argv[] = {"cmd", "-i", "a", "-i", "b"};
+  auto slow = [](const std::string&, const std::string&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    return std::make_tuple(true, std::string());
+  };
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-i", "help")->checker_async(slow);
+  cli.freeze();
+
+  auto start = std::chrono::steady_clock::now();
+  Result res = cli.try_parse(5, argv);
+  res = cli.try_parse(5, argv);
+  cli.parse(5, argv);
+  cli.reparse(5, argv);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+  EXPECT_TRUE(res.sync());
+  EXPECT_EQ(res.get<std::string>(cli.handle("i")), "b");
+}
+
+TEST(Parser, suggest)
+{
+  char* argv[] = {"cmd", "--kmr-size", "31"};
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-k/--kmer-size", "help")->def("31");
+  cli.add_param("-t/--threads", "help")->def("1");
+  cli.freeze();
+
+  Result res = cli.try_parse(3, argv);
+  ASSERT_FALSE(res.errors().empty());
+  EXPECT_NE(res.errors()[0].get_msg().find("did you mean --kmer-size?"),
+            std::string::npos);
+
+  char* short_typo[] = {"cmd", "-x", "31"};
+  res = cli.try_parse(3, short_typo);
+  ASSERT_FALSE(res.errors().empty());
+  EXPECT_EQ(res.errors()[0].get_msg().find("did you mean"), std::string::npos);
+}
+
+TEST(Parser, abbreviations)
+{
+  char* argv[] = {"cmd", "--count-abundance-mi", "2", "--th", "4"};
+  char* ambiguous[] = {"cmd", "--count-ab", "2"};
+  // restore the global default even when an ASSERT returns early
+  struct Restore { ~Restore() { conf::get().abbreviations(false); } } restore;
+  conf::get().abbreviations(true);
+  Parser cli("test", "test", "test", "test");
+  handle_t min = cli.handle(cli.add_param("--count-abundance-min", "help")->def("1"));
+  cli.add_param("--count-abundance-max", "help")->def("10");
+  handle_t t = cli.handle(cli.add_param("-t/--threads", "help")->def("1"));
+  cli.freeze();
+
+  Result res = cli.try_parse(5, argv);
+  ASSERT_TRUE(res);
+  EXPECT_EQ(res.get<int>(min), 2);
+  EXPECT_EQ(res.get<int>(t), 4);
+
+  res = cli.try_parse(3, ambiguous);
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_name(), "AmbiguousParamError");
+}
+
+TEST(Parser, tokenizer)
+{
+  char* argv[] = {"cmd", "--kmer-size=21", "-vd", "-t8", "-o", "-5", "-", "--", "-x", "--y"};
+  Parser cli("test", "test", "test", "test");
+  handle_t k = cli.handle(cli.add_param("-k/--kmer-size", "help")->def("31"));
+  handle_t t = cli.handle(cli.add_param("-t/--threads", "help")->def("1"));
+  handle_t o = cli.handle(cli.add_param("-o/--offset", "help")->def("0"));
+  cli.add_param("-v/--verbose", "help")->as_flag();
+  handle_t d = cli.handle(cli.add_param("-d/--debug", "help")->as_flag());
+  cli.freeze();
+
+  Result res = cli.try_parse(10, argv);
+  ASSERT_TRUE(res);
+  EXPECT_EQ(res.get<int>(k), 21);
+  EXPECT_EQ(res.get<int>(t), 8);
+  EXPECT_EQ(res.get<int>(o), -5);
+  EXPECT_TRUE(res.get<bool>(d));
+  EXPECT_EQ(res.get_positionals(), (std::vector<std::string>{"-", "-x", "--y"}));
+
+  char* bad[] = {"cmd", "-vz", "--debug=1"};
+  res = cli.try_parse(3, bad);
+  ASSERT_EQ(res.errors().size(), 2);
+  EXPECT_EQ(res.errors()[0].get_name(), "InvalidParamError");
+
+  // -inf is a bundle, not a number
+  char* inf[] = {"cmd", "-inf"};
+  Parser flags("test", "test", "test", "test");
+  handle_t i = flags.handle(flags.add_param("-i", "help")->as_flag());
+  handle_t n = flags.handle(flags.add_param("-n", "help")->as_flag());
+  handle_t f = flags.handle(flags.add_param("-f", "help")->as_flag());
+  flags.freeze();
+  res = flags.try_parse(2, inf);
+  ASSERT_TRUE(res);
+  EXPECT_TRUE(res.get<bool>(i) && res.get<bool>(n) && res.get<bool>(f));
+  EXPECT_TRUE(res.get_positionals().empty());
+
+  // -- doesn't give its next token to a param waiting for a value
+  char* eoo[] = {"cmd", "-o", "--", "-3"};
+  res = cli.try_parse(4, eoo);
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_name(), "MissingValueError");
+  EXPECT_EQ(res.get_positionals(), (std::vector<std::string>{"-3"}));
+}
+
+TEST(Parser, tokens)
+{
+  char* argv[] = {"cmd", "a.fa", "-k", "21", "b.fa", "-t", "x"};
+  Parser cli("test", "test", "test", "test");
+  handle_t k = cli.handle(cli.add_param("-k/--kmer-size", "help")->def("31"));
+  cli.add_param("-t/--threads", "help")->def("1")->checker(check::is_number);
+  cli.freeze();
+
+  Result res;
+  std::vector<std::string> seen;
+  for (const Token& t : cli.tokens(7, argv, res))
+  {
+    if (t.kind == Token::Kind::Positional)
+      seen.push_back(std::string(t.value));
+    else if (t.handle.id == k.id)
+      seen.push_back("k=" + std::string(t.value));
+  }
+  EXPECT_EQ(seen, (std::vector<std::string>{"a.fa", "k=21", "b.fa"}));
+  EXPECT_FALSE(res);
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.get<int>(k), 21);
+  EXPECT_EQ(res.get_positionals().size(), 2);
+
+  static_assert(!std::is_copy_constructible_v<Parser<>::Tokens>);
+  static_assert(!std::is_move_constructible_v<Parser<>::Tokens>);
+  Result res2;
+  auto tokens = cli.tokens(3, argv, res2);
+  Token t;
+  ASSERT_TRUE(tokens.next(t));
+  EXPECT_EQ(t.value, "a.fa");
+}
+
+TEST(Parser, positionals_from)
+{
+  char* argv[] = {"cmd", "-k", "21", "-"};
+  std::istringstream in("a.fa\n\nb.fa\r\nc.fa\n");
+  std::vector<std::string> seen;
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-k/--kmer-size", "help")->def("31");
+  cli.set_positional_bounds(1, 2, "", "");
+  cli.positionals_from(in);
+  cli.positionals_setter([&seen](const std::string& v) { seen.push_back(v); });
+  EXPECT_THROW(cli.parse(4, argv), ex::PositionalsError);
+  EXPECT_EQ(seen, (std::vector<std::string>{"a.fa", "b.fa", "c.fa"}));
+
+  std::istringstream in2("x.fa\ny.fa\n");
+  cli.positionals_from(in2);
+  Result res;
+  std::vector<std::string> tokens;
+  for (const Token& t : cli.tokens(4, argv, res))
+    if (t.kind == Token::Kind::Positional)
+      tokens.push_back(std::string(t.value));
+  EXPECT_TRUE(res);
+  EXPECT_EQ(tokens, (std::vector<std::string>{"x.fa", "y.fa"}));
+}
+
+TEST(Parser, parallel_positional_checks)
+{
+  std::vector<std::string> args {"cmd"};
+  for (int i=0; i<1000; i++)
+    args.push_back(i == 10 || i == 500 ? "x" + std::to_string(i) : std::to_string(i));
+  std::vector<char*> argv;
+  for (auto& a : args)
+    argv.push_back(a.data());
+
+  Parser cli("test", "test", "test", "test");
+  cli.positionals_checker(check::is_number);
+  cli.parallel_positional_checks(4);
+  cli.freeze();
+
+  Result res = cli.try_parse(argv.size(), argv.data());
+  ASSERT_EQ(res.errors().size(), 1);
+  const std::string& msg = res.errors()[0].get_msg();
+  EXPECT_NE(msg.find("positionals[10]"), std::string::npos);
+  EXPECT_NE(msg.find("positionals[500]"), std::string::npos);
+
+  // each positional is checked once, a failure is kept even if a new check would pass
+  std::atomic<int> calls {0};
+  Parser flaky("test", "test", "test", "test");
+  flaky.positionals_checker([&calls](const std::string& p, const std::string& v) {
+    bool ok = v != "x10" || calls++ > 0;
+    return std::make_tuple(ok, p + " " + v + " failed.");
+  });
+  flaky.parallel_positional_checks(4);
+  flaky.freeze();
+
+  res = flaky.try_parse(argv.size(), argv.data());
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_msg(), "positionals[10] x10 failed.");
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(Parser, parallel_checks_throw)
+{
+  std::vector<std::string> args {"cmd", "-r", ""};
+  for (int i=0; i<1000; i++)
+  {
+    args.push_back(std::to_string(i));
+    args[2] += (i ? "," : "") + std::to_string(i);
+  }
+  std::vector<char*> argv;
+  for (auto& a : args)
+    argv.push_back(a.data());
+  check::checker_fn_t throws = [](const std::string&, const std::string& v) -> check::checker_ret_t {
+    if (v == "500")
+      throw std::out_of_range("stoi");
+    return std::make_tuple(true, "");
+  };
+
+  Parser cli("test", "test", "test", "test");
+  cli.add_param("-r", "help")->multi()->checker(throws)->parallel_checks(4);
+  cli.freeze();
+  Result res = cli.try_parse(3, argv.data());
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_msg(), "stoi");
+
+  Parser pos("test", "test", "test", "test");
+  pos.positionals_checker(throws);
+  pos.parallel_positional_checks(4);
+  pos.freeze();
+  std::vector<char*> positionals {argv[0]};
+  positionals.insert(positionals.end(), argv.begin() + 3, argv.end());
+  res = pos.try_parse(positionals.size(), positionals.data());
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_msg(), "stoi");
+}
+
+TEST(Parser, expand)
+{
+  fs::path root = fs::temp_directory_path() / ("bcli_expand_" + std::to_string(::getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root / "run1");
+  for (auto& f : {"a.fq", "b.fq", "c.txt", "run1/d.fq"})
+    std::ofstream(root / f) << "x";
+
+  std::string dir = root.string();
+  std::string glob = dir + "/*.fq";
+  std::string all = dir + "/**";
+  char* argv[] = {"cmd", dir.data(), glob.data(), "-r", all.data()};
+
+  // expanded files are checked once, by the expansion filter
+  std::atomic<int> pos_checks {0}, reads_checks {0};
+  auto counted = [](std::atomic<int>& n) {
+    return [&n](const std::string& p, const std::string& v) {
+      n++;
+      return check::f::ext("fq")(p, v);
+    };
+  };
+
+  Parser cli("test", "test", "test", "test");
+  auto reads = cli.add_param("-r", "help")->def("")->multi()
+                  ->checker(counted(reads_checks))->expand(2);
+  cli.expand_positionals();
+  cli.positionals_checker(counted(pos_checks));
+  cli.freeze();
+
+  Result res = cli.try_parse(5, argv);
+  ASSERT_TRUE(res);
+  EXPECT_EQ(res.get_positionals().to_vector(),
+            (std::vector<std::string>{dir + "/a.fq", dir + "/b.fq", dir + "/a.fq", dir + "/b.fq"}));
+  EXPECT_EQ(res.get<std::vector<std::string>>(cli.handle(reads)),
+            (std::vector<std::string>{dir + "/a.fq", dir + "/b.fq", dir + "/run1/d.fq"}));
+  EXPECT_EQ(pos_checks, 5);
+  EXPECT_EQ(reads_checks, 4);
+  fs::remove_all(root);
+}
+
+TEST(Parser, dedup_inputs)
+{
+  fs::path root = fs::temp_directory_path() / ("bcli_dedup_" + std::to_string(::getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  std::ofstream(root / "a.fq") << "x";
+  std::ofstream(root / "b.fq") << "x";
+  fs::create_hard_link(root / "a.fq", root / "a_link.fq");
+  fs::create_symlink(root / "b.fq", root / "b_sym.fq");
+
+  std::string a = (root / "a.fq").string(), al = (root / "a_link.fq").string();
+  std::string b = (root / "b.fq").string(), bs = (root / "b_sym.fq").string();
+  char* argv[] = {"cmd", a.data(), al.data(), "-r", bs.data(), "-r", b.data()};
+
+  Parser cli("test", "test", "test", "test");
+  auto reads = cli.add_param("-r", "help")->def("")->multi();
+  cli.dedup_inputs(param::Dedup::Drop, {reads});
+  cli.freeze();
+
+  Result res = cli.try_parse(7, argv);
+  ASSERT_TRUE(res);
+  EXPECT_EQ(res.get_positionals().to_vector(), std::vector<std::string>{a});
+  EXPECT_EQ(res.get<std::vector<std::string>>(cli.handle(reads)), std::vector<std::string>{bs});
+
+  std::thread other([&]() { EXPECT_TRUE(cli.try_parse(7, argv)); });
+  EXPECT_TRUE(cli.try_parse(7, argv));
+  other.join();
+
+  cli.dedup_inputs(param::Dedup::Error, {reads});
+  res = cli.try_parse(7, argv);
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_name(), "DuplicateInputError");
+
+  // file ids are read on a worker under the deadline
+  cli.set_deadline(std::chrono::seconds(5));
+  res = cli.try_parse(7, argv);
+  ASSERT_EQ(res.errors().size(), 1);
+  EXPECT_EQ(res.errors()[0].get_name(), "DuplicateInputError");
+  fs::remove_all(root);
+}
+
+TEST(Parser, name_collision)
+{
+  char* argv[] = {"cmd", "-d", "run"};
+  Parser cli("test", "test", "test", "test");
+  handle_t d = cli.handle(cli.add_param("-d/--run-dir", "help"));
+  cli.add_common();
+  cli.freeze();
+
+  Result res = cli.try_parse(3, argv);
+  ASSERT_TRUE(res);
+  EXPECT_EQ(res.get<std::string>(d), "run");
+}
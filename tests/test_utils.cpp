@@ -182,4 +182,150 @@ TEST(utils, trim_params)
 
   EXPECT_EQ(utils::trim_param(sp), "t");
   EXPECT_EQ(utils::trim_param(lp), "test");
-}
\ No newline at end of file
+}
+TEST(utils, parse_range_list)
+{
+  std::vector<int> out;
+  std::vector<int8_t> out8;
+  EXPECT_TRUE(std::get<0>(utils::parse_range_list<int>("15-21:2,41,51-53", out)));
+  EXPECT_EQ(out, std::vector<int>({15, 17, 19, 21, 41, 51, 52, 53}));
+
+  EXPECT_TRUE(std::get<0>(utils::parse_range_list<int>("8,1-3,2", out)));
+  EXPECT_EQ(out, std::vector<int>({1, 2, 3, 8}));
+
+  EXPECT_TRUE(std::get<0>(utils::parse_range_list<int>("1-10:4", out)));
+  EXPECT_EQ(out, std::vector<int>({1, 5, 9}));
+
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("", out)));
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("1,", out)));
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("1-a", out)));
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("5-1", out)));
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("1-5:0", out)));
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("1-5,64", out, 1, 63)));
+  EXPECT_TRUE(out.empty());
+
+  EXPECT_TRUE(std::get<0>(utils::parse_range_list<int>("-2147483648-2147483647:1000000000", out)));
+  EXPECT_EQ(out, std::vector<int>({std::numeric_limits<int>::min(), -1147483648, -147483648, 852516352, 1852516352}));
+  EXPECT_TRUE(std::get<0>(utils::parse_range_list<int8_t>("-128-127:127", out8)));
+  EXPECT_EQ(out8, std::vector<int8_t>({-128, -1, 126}));
+
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("0-2000000000", out)));
+  EXPECT_FALSE(std::get<0>(utils::parse_range_list<int>("1-6,10-15", out, 0, 100, 10)));
+  EXPECT_TRUE(std::get<0>(utils::parse_range_list<int>("1-5,10-14", out, 0, 100, 10)));
+}
+
+TEST(utils, parallel_for)
+{
+  std::vector<int> out(1000, 0);
+  utils::parallel_for(out.size(), 4, [&](size_t i) { out[i] = static_cast<int>(i); });
+  EXPECT_EQ(out[999], 999);
+
+  auto fail = [](size_t i) {
+    if (i == 500)
+      throw std::out_of_range("stoi");
+  };
+  EXPECT_THROW(utils::parallel_for(1000, 4, fail), std::out_of_range);
+  EXPECT_THROW(utils::parallel_for(1000, 1, fail), std::out_of_range);
+
+  fs::path root = fs::temp_directory_path() / ("bcli_walk_" + std::to_string(::getpid()));
+  fs::create_directories(root / "a" / "b");
+  for (auto& f : {"x", "a/y", "a/b/z"})
+    std::ofstream(root / f) << "x";
+  std::atomic<int> files {0};
+  utils::walk_dir(root.string(), true, 4, [&](const std::string&, uint64_t) { files++; });
+  EXPECT_EQ(files, 3);
+  EXPECT_THROW(utils::walk_dir(root.string(), true, 4, [](const std::string& path, uint64_t) {
+    if (utils::endswith(path, "y"))
+      throw std::runtime_error(path);
+  }), std::runtime_error);
+  fs::remove_all(root);
+}
+
+TEST(utils, dfa)
+{
+  utils::Dfa sample("[A-Z]{2}[0-9]{2,4}(_R[12])?");
+  EXPECT_TRUE(sample.match("AB12"));
+  EXPECT_TRUE(sample.match("AB1234_R2"));
+  EXPECT_FALSE(sample.match("AB1"));
+  EXPECT_FALSE(sample.match("AB12345"));
+  EXPECT_FALSE(sample.match("ab12_R1"));
+
+  utils::Dfa rg("^(ID|SM):\\w+(\\.\\d+)*$");
+  EXPECT_TRUE(rg.match("SM:na12878.1.2"));
+  EXPECT_FALSE(rg.match("LB:na12878"));
+  EXPECT_FALSE(rg.match(""));
+
+  utils::Dfa glob = utils::Dfa::from_glob("run_{hiseq,novaseq}_*.[ct]sv");
+  EXPECT_TRUE(glob.match("run_novaseq_42.tsv"));
+  EXPECT_FALSE(glob.match("run_miseq_42.tsv"));
+  EXPECT_FALSE(glob.match("run_hiseq_42xtsv"));
+
+  EXPECT_THROW(utils::Dfa("(ab"), ex::PatternError);
+  EXPECT_THROW(utils::Dfa("a**"), ex::PatternError);
+}
+
+TEST(utils, edit_distance)
+{
+  EXPECT_EQ(utils::edit_distance("--kmr", "--kmer", 2), 1);
+  EXPECT_EQ(utils::edit_distance("--kmer-szie", "--kmer-size", 3), 2);
+  EXPECT_EQ(utils::edit_distance("index", "index", 1), 0);
+  EXPECT_EQ(utils::edit_distance("query", "--threads", 2), 3);
+
+  utils::NameIndex index;
+  for (auto& n : {"build", "index", "query", "merge", "stats"})
+    index.add(n);
+  index.freeze();
+  EXPECT_EQ(index.suggest("indx"), vstring{"index"});
+  EXPECT_TRUE(index.suggest("xyz").empty());
+
+  utils::NameIndex shorts;
+  for (auto& n : {"-k", "-t", "-o", "--kmer-size"})
+    shorts.add(n);
+  shorts.freeze();
+  EXPECT_TRUE(shorts.suggest("-x").empty());
+  EXPECT_EQ(shorts.suggest("--kmer-sze"), vstring{"--kmer-size"});
+}
+
+TEST(utils, radix_trie)
+{
+  utils::RadixTrie trie;
+  for (auto& n : {"count-abundance-min", "count-abundance-max", "count", "threads", "tmp-dir"})
+    trie.insert(n);
+  trie.freeze();
+  EXPECT_EQ(trie.complete("th"), vstring{"threads"});
+  EXPECT_EQ(trie.complete("count"), vstring{"count"});
+  EXPECT_EQ(trie.complete("count-abundance-mi"), vstring{"count-abundance-min"});
+  EXPECT_EQ(trie.complete("count-ab").size(), 2);
+  EXPECT_EQ(trie.complete("t").size(), 2);
+  EXPECT_TRUE(trie.complete("x").empty());
+}
+
+TEST(utils, front_coded_store)
+{
+  utils::FrontCodedStore store;
+  std::vector<std::string> paths;
+  for (int i=0; i<100; i++)
+    paths.push_back("/data/metagenomes/run_" + std::to_string(i / 10) + "/sample_" +
+                    std::to_string(i) + ".fastq.gz");
+  paths.push_back("");
+  paths.push_back("x");
+  for (auto& p : paths)
+    store.push_back(p);
+
+  ASSERT_EQ(store.size(), paths.size());
+  std::string buffer;
+  for (size_t i : {0, 1, 15, 16, 17, 99, 100, 101})
+    EXPECT_EQ(store.get(i, buffer), paths[i]);
+  EXPECT_EQ(store[42], paths[42]);
+  EXPECT_EQ(store.to_vector(), paths);
+  EXPECT_EQ(store, paths);
+  size_t i = 0;
+  for (auto& p : store)
+    EXPECT_EQ(p, paths[i++]);
+  EXPECT_EQ(i, paths.size());
+  EXPECT_LT(store.bytes(), 100 * 20);
+
+  store.clear();
+  EXPECT_TRUE(store.empty());
+  EXPECT_EQ(store.begin(), store.end());
+}